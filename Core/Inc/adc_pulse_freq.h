@@ -3,33 +3,269 @@
  * @brief Header file for ADC pulse frequency measurement library.
  *
  * This library provides functions to measure the frequency of pulses on ADC_IN0.
+ *
+ * The measurement core (comparator, period conversion, sync matching,
+ * envelope tracking) in adc_pulse_freq.c is portable and only sees blocks of
+ * samples and crossing timestamps. FREQ_Init/Start/Stop and the ADC
+ * callbacks live in the platform backend, adc_pulse_freq_stm32.c on target.
+ *
+ * Building with SVO_PARAMS defined takes the tuned detection settings from
+ * svo_params.h, as exported by the host parameter sweep (Host/svo_sweep);
+ * the values below are the defaults for anything it does not set.
  */
 
 #ifndef ADC_PULSE_FREQ_H
 #define ADC_PULSE_FREQ_H
 
-#include "main.h"
-#include "CircularBuffer.h"
+#include "platform.h"
+#include "sample_queue.h"
+#include "profile.h"
+#include "goertzel.h"
+#include "video_std.h"
+#include "events.h"
+
+#ifdef SVO_PARAMS
+#include "svo_params.h"
+#endif
+
+/**
+ * @defgroup FreqSampleUnits Published Sample Units
+ * @brief The meter publishes uint16_t line frequencies in kHz, Q8.8 fixed point
+ * @{
+ */
+#define FREQ_TICK_HZ          48000000U  ///< Tick rate used for internal period measurement (core clock)
+#define FREQ_PERIOD_MAX       0xFFFFU    ///< Clamp for periods that do not fit 16 bits (below ~732 Hz)
+#define FREQ_SCALE_SHIFT      4          ///< Fraction bits of the sample-to-tick scale factor
+#define FREQ_Q8_SHIFT         8          ///< Fraction bits of published frequencies
+#define FREQ_KHZ_Q8(khz)      ((uint16_t)((khz) * (1 << FREQ_Q8_SHIFT) + 0.5))  ///< kHz constant to Q8.8
+/** @} */
+
+/**
+ * @defgroup FreqDmaSettings DMA Acquisition Settings
+ * @brief Parameters for continuous ADC acquisition into a circular DMA buffer
+ * @{
+ */
+#define FREQ_DMA_BUF_LEN      256        ///< Circular DMA buffer length in samples (two halves)
+#define FREQ_DMA_SAMPLETIME   ADC_SAMPLETIME_7CYCLES_5  ///< Sampling time used in DMA mode
+#define FREQ_DMA_SAMPLE_RATE  875000U    ///< 14 MHz ADC clock / (7.5 + 8.5 cycles at 8 bit)
+#define FREQ_MAX_SAMPLE_RATE  FREQ_DMA_SAMPLE_RATE  ///< Upper bound for timer-triggered sampling
+#define FREQ_MIN_SAMPLE_RATE  100000U    ///< Lower bound for timer-triggered sampling
+#define FREQ_WAKE_LEVEL       (SQ_SIZE / 2)  ///< Queued samples that post EV_SAMPLES
+/** @} */
+
+/**
+ * @defgroup FreqEnvelopeSettings Adaptive Threshold Settings
+ * @brief Envelope tracking used in DMA mode when FrequencyMeter_t::adaptive is set
+ *
+ * Sync tip and peak levels are followed with fast-attack / slow-decay
+ * envelopes updated once per DMA block; the hysteresis band is placed at a
+ * fixed fraction of the envelope span for the next block.
+ * @{
+ */
+#define FREQ_ENV_STRIDE       2          ///< Step between envelope probes in samples (sync tip spans ~4 samples)
+#define FREQ_ENV_ATTACK_SHIFT 1          ///< Envelope moves 1/2 of the way towards a wider block extreme
+#define FREQ_ENV_DECAY_SHIFT  6          ///< Envelope moves 1/64 of the way towards a narrower one (~9 ms)
+#ifndef FREQ_ENV_HIGH_Q8
+#define FREQ_ENV_HIGH_Q8      77         ///< Default env_high_q8, 0.3 of the span above the sync tip
+#endif
+#ifndef FREQ_ENV_LOW_Q8
+#define FREQ_ENV_LOW_Q8       38         ///< Default env_low_q8, 0.15 of the span, between sync tip and blanking
+#endif
+#define FREQ_ENV_MIN_SPAN     12         ///< Smallest span used for the band, keeps thresholds out of the noise
+/** @} */
+
+/**
+ * @defgroup FreqSyncSettings Sync Pulse Matching
+ * @brief Horizontal sync shape used to reject non-video interferers
+ * @{
+ */
+#define FREQ_US_TO_TICKS(us)  ((uint16_t)((us) * (FREQ_TICK_HZ / 1000000U)))  ///< Microseconds to timebase ticks
+#define FREQ_SYNC_PERIOD_MIN  FREQ_US_TO_TICKS(60)  ///< Shortest line period counted as matched
+#define FREQ_SYNC_PERIOD_MAX  FREQ_US_TO_TICKS(68)  ///< Longest line period counted as matched
+/** @} */
+
+/**
+ * @brief Sync matching counters, accumulated until taken with FREQ_TakeSyncStats().
+ */
+typedef struct {
+    uint16_t pulses;            /**< Complete pulses seen (rising edge with a known previous pulse) */
+    uint16_t width_ok;          /**< Pulses whose width matched the sync window */
+    uint16_t period_ok;         /**< Pulses whose period matched a video line */
+    uint16_t matched;           /**< Pulses matching both width and period */
+} FREQ_SyncStats_t;
+
+/**
+ * @defgroup FreqToneSettings Tone Detector Settings
+ * @brief Goertzel bank run over DMA blocks when FrequencyMeter_t::goertzel is set
+ * @{
+ */
+#define FREQ_GZ_PAL_HZ        15625U     ///< PAL line frequency bin
+#define FREQ_GZ_NTSC_HZ       15734U     ///< NTSC line frequency bin
+#define FREQ_GZ_REF_HZ        23500U     ///< Noise reference bin, between line harmonics
+#define FREQ_GZ_N             1024U      ///< Decimated samples per evaluation (~98 Hz bins at 800 ksps)
+/** @} */
+
+/**
+ * @brief Goertzel bank bin indices.
+ */
+enum {
+    FREQ_GZ_BIN_PAL,
+    FREQ_GZ_BIN_NTSC,
+    FREQ_GZ_BIN_REF
+};
+
+/**
+ * @brief Acquisition modes.
+ */
+typedef enum {
+    FREQ_MODE_IT,   /**< One ADC interrupt per conversion, timebase timestamps */
+    FREQ_MODE_DMA,  /**< Continuous conversion into a circular DMA buffer */
+    FREQ_MODE_AWD   /**< Continuous conversion, analog watchdog interrupt on threshold crossings only */
+} FREQ_Mode_t;
+
 /**
  * @brief Structure for frequency measurement.
  */
 typedef struct {
     ADC_HandleTypeDef* hadc;
     uint32_t adcChannel;
-    TIM_HandleTypeDef* htim;
-    uint8_t threshold_high;
-    uint8_t threshold_low;
-    CircularBuffer* frequency;
-    uint32_t _last_time;
+    TIM_HandleTypeDef* htim;    /**< Timebase in IT/AWD modes, sample clock for timer-triggered DMA */
+    DMA_HandleTypeDef* hdma;    /**< DMA channel for FREQ_MODE_DMA, may be NULL otherwise */
+    FREQ_Mode_t mode;
+    uint8_t threshold_high;     /**< Rising crossing level, rewritten every block when adaptive */
+    uint8_t threshold_low;      /**< Falling crossing level, rewritten every block when adaptive */
+    uint8_t adaptive;           /**< DMA mode: derive the thresholds from the signal envelope */
+    uint8_t env_high_q8;        /**< Adaptive threshold_high as a fraction of the envelope span, Q8 */
+    uint8_t env_low_q8;         /**< Adaptive threshold_low as a fraction of the envelope span, Q8 */
+    uint32_t sample_rate;       /**< DMA mode: TIM TRGO sample clock in Hz, 0 = free-running ADC */
+    uint8_t goertzel;           /**< DMA mode: also run the Goertzel tone detector on each block */
+    uint16_t sync_width_min;    /**< Shortest accepted sync pulse in ticks, 0 disables width matching */
+    uint16_t sync_width_max;    /**< Longest accepted sync pulse in ticks */
+    SampleQueue_t* frequency;   /**< Receives line frequency samples, kHz Q8.8 */
+    VideoStd_t* video;          /**< Field structure tracker fed with every period, may be NULL */
+    volatile uint8_t _epoch;    /**< Tag of new samples, advanced from the main loop */
+    uint32_t _last_time;        /**< Timestamp of the last rising crossing */
+    uint16_t _pulse_width;      /**< Ticks above threshold of the last pulse */
+    FREQ_SyncStats_t _sync;
     uint8_t _triggered;
-    uint32_t _timeout;
+    uint16_t _env_min;          /**< Sync tip envelope, Q8 ADC counts */
+    uint16_t _env_max;          /**< Peak envelope, Q8 ADC counts */
+    uint32_t _tick_rate;        /**< Timestamp units per second */
+    uint16_t _period_scale;     /**< Ticks per timestamp unit, Q(FREQ_SCALE_SHIFT) */
+    uint32_t _sample_idx;       /**< Running sample index used as timestamp in DMA mode */
+    uint32_t _rate_idx;         /**< Sample index at the last FREQ_MeasureSampleRate() call */
+    uint32_t _rate_tick;        /**< HAL tick at the last FREQ_MeasureSampleRate() call */
+    uint8_t _dma_buf[FREQ_DMA_BUF_LEN];
+    Goertzel_t _gz;
+#ifdef FREQ_PROFILE
+    Profile_t prof_edge;        /**< Cycles spent publishing one sample */
+    Profile_t prof_goertzel;    /**< Cycles spent in the tone detector per half-buffer */
+#endif
 
 } FrequencyMeter_t;
 
+_Static_assert(((FREQ_TICK_HZ << FREQ_SCALE_SHIFT) + FREQ_MIN_SAMPLE_RATE / 2) / FREQ_MIN_SAMPLE_RATE <= UINT16_MAX,
+               "_period_scale overflows at FREQ_MIN_SAMPLE_RATE");
+
+/**
+ * @defgroup FreqBackend Platform Backend
+ * @brief Acquisition hardware, implemented per platform
+ * @{
+ */
 void FREQ_Init(FrequencyMeter_t* freq_meter);
 
 void FREQ_Start(FrequencyMeter_t* freq_meter);
 
 void FREQ_Stop(FrequencyMeter_t* freq_meter);
+/** @} */
+
+/**
+ * @brief Sets the timestamp rate and derives the period scale and tone detector coefficients.
+ *
+ * @param tick_rate Timestamp units per second: sample rate in DMA mode, timer rate otherwise.
+ */
+void FREQ_Configure(FrequencyMeter_t* freq_meter, uint32_t tick_rate);
+
+/**
+ * @brief Clears comparator, envelope and statistics state before acquisition starts.
+ */
+void FREQ_Reset(FrequencyMeter_t* freq_meter);
+
+/**
+ * @brief Runs the hysteresis comparator over a block of consecutive samples.
+ *
+ * Comparator state is kept in locals for the whole block; the sample index
+ * serves as timestamp, so no timer is read on this path. Also updates the
+ * adaptive thresholds and the tone detector when enabled.
+ */
+void FREQ_ProcessBlock(FrequencyMeter_t* freq_meter, const uint8_t* block, uint32_t len);
+
+/**
+ * @brief Publishes the line frequency for the period that ends at a rising crossing.
+ *
+ * The period is rescaled to FREQ_TICK_HZ ticks with one multiply and turned
+ * into a frequency by table lookup; the F030 has no hardware divider, so no
+ * division is done here.
+ *
+ * With sync matching enabled, a period whose pulse does not have the sync
+ * width is published as 0, i.e. out of any channel band. Either phase of the
+ * pulse may be the sync tip, so the input polarity does not matter.
+ *
+ * @param now Timestamp of the crossing in _tick_rate units.
+ */
+void FREQ_OnRise(FrequencyMeter_t* freq_meter, uint32_t now);
+
+/**
+ * @brief Records the width of the pulse that ends at a falling crossing.
+ *
+ * @param now Timestamp of the crossing in _tick_rate units.
+ */
+void FREQ_OnFall(FrequencyMeter_t* freq_meter, uint32_t now);
+
+/**
+ * @brief Returns the programmed sample rate in Hz.
+ *
+ * For timer-triggered sampling this is the rate actually produced by the
+ * timer divider, which may differ from the requested sample_rate.
+ */
+uint32_t FREQ_GetSampleRate(const FrequencyMeter_t* freq_meter);
+
+/**
+ * @brief Measures the DMA sample rate since the previous call or FREQ_Start().
+ *
+ * @return Samples per second counted against PLAT_GetTick, 0 if no time has elapsed.
+ */
+uint32_t FREQ_MeasureSampleRate(FrequencyMeter_t* freq_meter);
+
+/**
+ * @brief Starts a new sample epoch, e.g. on a channel step.
+ *
+ * Samples measured from now on carry the returned tag, so consumers can
+ * tell them from samples of the previous channel still in the queue. The
+ * field tracker is cleared in the same step, so confidence built up on the
+ * previous channel cannot confirm the new one.
+ *
+ * @return The new epoch.
+ */
+static inline uint8_t FREQ_NextEpoch(FrequencyMeter_t* freq_meter) {
+    PLAT_CRITICAL_ENTER();
+    uint8_t epoch = freq_meter->_epoch + 1;
+    freq_meter->_epoch = epoch;
+    if (freq_meter->video != NULL) VS_Reset(freq_meter->video);
+    PLAT_CRITICAL_EXIT();
+    return epoch;
+}
+
+/**
+ * @brief Returns the sync matching counters gathered since the previous call and clears them.
+ */
+void FREQ_TakeSyncStats(FrequencyMeter_t* freq_meter, FREQ_SyncStats_t* stats);
+
+/**
+ * @brief Line tone to noise reference energy ratio of the last Goertzel evaluation.
+ *
+ * @return Stronger of the PAL/NTSC bins over the reference bin, Q8 (256 = equal energy).
+ */
+uint16_t FREQ_GetToneRatio(const FrequencyMeter_t* freq_meter);
 
 #endif // ADC_PULSE_FREQ_H
@@ -0,0 +1,56 @@
+/**
+ * @file buttons.h
+ * @brief Interrupt-driven debouncing of the BTN_P and BTN_M push buttons.
+ *
+ * A falling edge on either button (EXTI) wakes the CPU and arms a sampler
+ * that runs from SysTick once per millisecond. Each button has an
+ * integrating counter that moves one step towards the raw pin level per
+ * tick; the debounced state flips only when the counter reaches an end, so
+ * contact bounce shorter than BTN_DEBOUNCE_MS is absorbed. The sampler
+ * disarms itself once both buttons are stably released.
+ *
+ * Debounced press/release edges are latched and posted as EV_BUTTON; the
+ * main loop takes them without ever waiting.
+ */
+
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include "platform.h"
+
+#define BTN_DEBOUNCE_MS     10      ///< Integration length, in sampler ticks (ms)
+
+/**
+ * @defgroup ButtonMasks Button Bit Masks
+ * @{
+ */
+#define BTN_MASK_P          (1U << 0)   ///< BTN_P, search up
+#define BTN_MASK_M          (1U << 1)   ///< BTN_M, search down
+/** @} */
+
+/**
+ * @brief Configures both button pins for falling-edge EXTI and enables their interrupts.
+ */
+void BTN_Init(void);
+
+/**
+ * @brief Debounce sampler step, call from SysTick once per millisecond.
+ */
+void BTN_Tick(void);
+
+/**
+ * @brief Debounced state of the buttons held down now.
+ */
+uint8_t BTN_State(void);
+
+/**
+ * @brief Returns the buttons pressed since the previous call and clears them.
+ */
+uint8_t BTN_TakePressed(void);
+
+/**
+ * @brief Returns the buttons released since the previous call and clears them.
+ */
+uint8_t BTN_TakeReleased(void);
+
+#endif // BUTTONS_H
@@ -0,0 +1,132 @@
+/**
+ * @file channel_detector.h
+ * @brief Sliding-window channel presence detector over line frequency samples.
+ *
+ * A channel is present when at most `threshold` of the last `len` samples
+ * fall outside [min_val, max_val]. The window is kept as one bit per sample
+ * in 32-bit words, shifted by a whole batch at once; the out-of-range count
+ * is a popcount of those words after each batch, so the presence decision
+ * is a single comparison.
+ *
+ * Only samples tagged with the detector's epoch are counted, so samples
+ * from a previous channel still in flight are dropped without a cooldown.
+ *
+ * The same samples also drive a sequential probability ratio test (SPRT):
+ * each in-range or out-of-range sample adds a fixed log-likelihood step, and
+ * the test decides "signal" or "noise" as soon as the accumulated evidence
+ * crosses the bound set by the configured false-alarm and miss rates,
+ * without waiting for the window to fill.
+ */
+
+#ifndef CHANNEL_DETECTOR_H
+#define CHANNEL_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sample_queue.h"
+
+#define CD_MAX_WINDOW   128     ///< Largest supported window length
+#define CD_WORDS        ((CD_MAX_WINDOW + 31) / 32)  ///< Words of window history
+
+#define CD_PROB_RAW(p)  ((uint32_t)((p) * 65536.0 + 0.5))  ///< Probability to Q0.16 without the range check
+
+/// Probability constant to Q0.16; fails to compile unless it rounds to 1..65535, i.e. 0 < p < 1
+#define CD_PROB_Q16(p)  ((uint16_t)(CD_PROB_RAW(p) + 0 * sizeof(struct { \
+    unsigned prob_out_of_range : (CD_PROB_RAW(p) >= 1 && CD_PROB_RAW(p) <= 0xFFFFU) ? 1 : -1; })))
+
+/**
+ * @brief Sequential test outcome.
+ */
+typedef enum {
+    CD_UNDECIDED,   /**< Evidence still between the bounds */
+    CD_SIGNAL,      /**< Channel carries a video signal */
+    CD_NOISE        /**< Channel is empty */
+} CD_Decision_t;
+
+/**
+ * @brief Detector configuration and window state.
+ */
+typedef struct {
+    uint16_t min_val;           /**< Minimum valid frequency, kHz Q8.8 */
+    uint16_t max_val;           /**< Maximum valid frequency, kHz Q8.8 */
+    uint8_t len;                /**< Window length in samples */
+    uint8_t threshold;          /**< Max allowed number of out-of-range samples */
+    uint8_t out_count;          /**< Out-of-range samples currently in the window */
+    uint8_t epoch;              /**< Samples with another epoch are ignored */
+    uint32_t out_bits[CD_WORDS]; /**< 1 per out-of-range sample, bit 0 of word 0 is the newest */
+    int16_t llr_in;             /**< SPRT step for an in-range sample, log2 Q8 */
+    int16_t llr_out;            /**< SPRT step for an out-of-range sample, log2 Q8 */
+    int32_t llr_upper;          /**< Decide CD_SIGNAL at or above, log2 Q8 */
+    int32_t llr_lower;          /**< Decide CD_NOISE at or below, log2 Q8 */
+    int32_t llr;                /**< Accumulated log-likelihood ratio, kept within the bounds */
+} ChannelDetector_t;
+
+/**
+ * @brief Configures the detector and clears the window.
+ *
+ * @param len Window length, clamped to CD_MAX_WINDOW.
+ */
+void CD_Init(ChannelDetector_t *cd, uint16_t min_val, uint16_t max_val, uint8_t len, uint8_t threshold);
+
+/**
+ * @brief Configures the sequential test. Until called, CD_Decide() stays undecided.
+ *
+ * All arguments are Q0.16 probabilities, see CD_PROB_Q16(). A zero is
+ * taken as 1/65536, so no bound or step becomes infinite.
+ *
+ * @param p_signal Probability that a sample is in range when a channel is present.
+ * @param p_noise Probability that a sample is in range on an empty channel.
+ * @param alpha Target false-alarm rate (CD_SIGNAL on an empty channel).
+ * @param beta Target miss rate (CD_NOISE on an occupied channel).
+ */
+void CD_InitSPRT(ChannelDetector_t *cd, uint16_t p_signal, uint16_t p_noise, uint16_t alpha, uint16_t beta);
+
+/**
+ * @brief Clears the window and the sequential test evidence.
+ *
+ * Every sample of the window counts as out of range until replaced.
+ */
+void CD_Reset(ChannelDetector_t *cd);
+
+/**
+ * @brief Switches to a new sample epoch and clears the window and the evidence.
+ */
+void CD_SetEpoch(ChannelDetector_t *cd, uint8_t epoch);
+
+/**
+ * @brief Pushes the samples of the current epoch into the window, evicting the oldest ones.
+ *
+ * @return Number of samples that belonged to the current epoch.
+ */
+uint8_t CD_Add(ChannelDetector_t *cd, const FreqSample_t *samples, uint8_t count);
+
+/**
+ * @brief Number of set bits, without a popcount instruction (Cortex-M0).
+ *
+ * SWAR bit counting: pairwise, nibble and byte sums, then one multiply to
+ * add the four bytes.
+ */
+static inline uint8_t CD_Popcount(uint32_t x) {
+    x = x - ((x >> 1) & 0x55555555U);
+    x = (x & 0x33333333U) + ((x >> 2) & 0x33333333U);
+    x = (x + (x >> 4)) & 0x0F0F0F0FU;
+    return (uint8_t)((x * 0x01010101U) >> 24);
+}
+
+/**
+ * @brief Channel presence decision for the current window.
+ */
+static inline bool CD_IsPresent(const ChannelDetector_t *cd) {
+    return cd->out_count <= cd->threshold;
+}
+
+/**
+ * @brief Sequential test decision for the evidence gathered since the last reset.
+ */
+static inline CD_Decision_t CD_Decide(const ChannelDetector_t *cd) {
+    if (cd->llr_upper != 0 && cd->llr >= cd->llr_upper) return CD_SIGNAL;
+    if (cd->llr_lower != 0 && cd->llr <= cd->llr_lower) return CD_NOISE;
+    return CD_UNDECIDED;
+}
+
+#endif // CHANNEL_DETECTOR_H
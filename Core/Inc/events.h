@@ -0,0 +1,68 @@
+/**
+ * @file events.h
+ * @brief Event flags posted from interrupts and a sleeping wait for the main loop.
+ *
+ * Interrupt handlers set bits in a pending mask; the main loop takes the
+ * whole mask at once and otherwise sleeps with WFI. Time spent asleep is
+ * counted with the SysTick down-counter, so main loop iterations and the
+ * idle fraction can be read back with EV_TakeStats().
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "platform.h"
+
+#define EV_SLEEP        1       ///< 0 busy-polls instead of sleeping, for before/after comparison
+
+/**
+ * @defgroup EventFlags Event Flags
+ * @{
+ */
+#define EV_TICK         (1U << 0)   ///< SysTick, once per millisecond
+#define EV_SAMPLES      (1U << 1)   ///< Frequency sample queue needs draining
+#define EV_BUTTON       (1U << 2)   ///< Debounced button press or release
+#define EV_STEP         (1U << 3)   ///< Channel step pulse completed
+/** @} */
+
+/**
+ * @brief Main loop load since the previous EV_TakeStats() call.
+ *
+ * Idle fraction is idle_cycles / cycles.
+ */
+typedef struct {
+    uint32_t iterations;        /**< Returns from EV_Wait() */
+    uint32_t idle_cycles;       /**< CPU cycles spent in WFI */
+    uint32_t cycles;            /**< CPU cycles elapsed, at SysTick resolution */
+} EV_Stats_t;
+
+/**
+ * @brief Pending event mask, written from interrupts. Use EV_Post() and EV_Wait().
+ */
+extern volatile uint32_t ev_pending;
+
+/**
+ * @brief Sets event flags. Safe from any interrupt priority and from thread mode.
+ */
+static inline void EV_Post(uint32_t events) {
+    PLAT_CRITICAL_ENTER();
+    ev_pending |= events;
+    PLAT_CRITICAL_EXIT();
+}
+
+/**
+ * @brief Sleeps until at least one event is pending, then takes and clears all of them.
+ *
+ * Call only with interrupts enabled, from the main loop: the sleep toggles
+ * PRIMASK explicitly and always returns with interrupts enabled.
+ *
+ * @return Mask of the events posted since the previous call.
+ */
+uint32_t EV_Wait(void);
+
+/**
+ * @brief Returns the load counters gathered since the previous call and clears them.
+ */
+void EV_TakeStats(EV_Stats_t *stats);
+
+#endif // EVENTS_H
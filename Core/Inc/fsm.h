@@ -6,7 +6,33 @@
 #ifndef INC_FSM_H_
 #define INC_FSM_H_
 
-#include "main.h"
+#include "platform.h"
+#include "video_std.h"
+
+/**
+ * @brief Channel decision parameters.
+ *
+ * The build-time settings in fsm.c are the defaults; the host tools change
+ * them between runs to compare detector variants.
+ */
+typedef struct {
+    uint16_t ch_min;            /**< Lowest in-band line frequency, kHz Q8.8 */
+    uint16_t ch_max;            /**< Highest in-band line frequency, kHz Q8.8 */
+    uint8_t window_len;         /**< Samples in the presence window */
+    uint8_t ch_thr;             /**< Out-of-band samples tolerated in a present window */
+    uint8_t field_min_conf;     /**< Consistent video fields required before alarming, 0 skips the check */
+    uint8_t sequential;         /**< 1: the sequential test decides, 0: the count over a full window decides */
+} FSM_Detection_t;
+
+/**
+ * @brief Channel decision parameters of this build.
+ */
+void FSM_DefaultDetection(FSM_Detection_t *detection);
+
+/**
+ * @brief Replaces the channel decision parameters, effective from the next FSM_Init().
+ */
+void FSM_SetDetection(const FSM_Detection_t *detection);
 
 /**
  * @brief Initialize the FSM and ensure all outputs are off.
@@ -18,4 +44,24 @@ void FSM_Init(void);
  */
 void FSM_Process(void);
 
+/**
+ * @brief Duration of the last complete full-band sweep in milliseconds, 0 if none finished yet.
+ */
+uint32_t FSM_GetSweepTime(void);
+
+/**
+ * @brief Current channel index, counted in steps from the power-on position.
+ */
+uint8_t FSM_GetChannel(void);
+
+/**
+ * @brief true while the FSM is signalling a found channel.
+ */
+bool FSM_InAlarm(void);
+
+/**
+ * @brief Video standard confirmed for the last alarm, VS_UNKNOWN if the field check is off.
+ */
+VS_Standard_t FSM_GetStandard(void);
+
 #endif /* INC_FSM_H_ */
@@ -0,0 +1,75 @@
+/**
+ * @file goertzel.h
+ * @brief Fixed-point Goertzel tone detector for blocks of 8-bit ADC samples.
+ *
+ * Raw samples are first decimated by summing GZ_DECIM of them, which also
+ * acts as a boxcar anti-alias filter, then a bank of GZ_BINS single-bin
+ * Goertzel filters runs at the decimated rate. Everything is integer: the
+ * per-sample cost is one add, and per decimated sample two MULS per bin.
+ * Energies are latched every `n` decimated samples; ratios against the
+ * reference bin are computed on demand outside interrupt context, from a
+ * snapshot taken with GZ_Energies().
+ *
+ * Cost on the Cortex-M0 is an unmeasured estimate of about 1.3k cycles per
+ * 128-sample block; FrequencyMeter_t::prof_goertzel records the real figure
+ * in FREQ_PROFILE builds.
+ */
+
+#ifndef GOERTZEL_H
+#define GOERTZEL_H
+
+#include <stdint.h>
+
+#define GZ_BINS          3      ///< Number of bins in the bank
+#define GZ_DECIM         8      ///< Raw samples summed into one decimated sample
+#define GZ_COEFF_SHIFT   14     ///< Fraction bits of 2*cos(w)
+#define GZ_ENERGY_SHIFT  16     ///< Right shift applied to latched energies
+
+#define GZ_BARRIER() __asm volatile ("" ::: "memory")  ///< Compiler barrier, enough on a single core
+
+/**
+ * @brief Goertzel bank state.
+ */
+typedef struct {
+    int32_t coeff[GZ_BINS];     /**< 2*cos(2*pi*f/fs), Q14 */
+    int32_t s1[GZ_BINS];        /**< Filter state, previous output */
+    int32_t s2[GZ_BINS];        /**< Filter state, output before previous */
+    uint32_t energy[GZ_BINS];   /**< Bin energies of the last completed evaluation */
+    uint16_t n;                 /**< Decimated samples per evaluation */
+    uint16_t count;             /**< Decimated samples in the current evaluation */
+    int32_t acc;                /**< Partial sum of the current decimated sample */
+    uint8_t acc_count;          /**< Raw samples in acc */
+    volatile uint8_t seq;       /**< Incremented each time energies are latched */
+} Goertzel_t;
+
+/**
+ * @brief Computes bin coefficients and clears the filter state.
+ *
+ * @param sample_rate Raw sample rate in Hz.
+ * @param freqs_hz Bin centre frequencies in Hz, each below sample_rate / (2 * GZ_DECIM).
+ * @param n Decimated samples per evaluation; bin width is sample_rate / (GZ_DECIM * n).
+ */
+void GZ_Init(Goertzel_t *gz, uint32_t sample_rate, const uint32_t freqs_hz[GZ_BINS], uint16_t n);
+
+/**
+ * @brief Runs the bank over a block of raw 8-bit samples.
+ */
+void GZ_Process(Goertzel_t *gz, const uint8_t *samples, uint32_t len);
+
+/**
+ * @brief Copies the energies of the last evaluation, all from the same one.
+ *
+ * Safe against GZ_Process() running in an interrupt: the copy is retried
+ * until no latch happened during it.
+ */
+void GZ_Energies(const Goertzel_t *gz, uint32_t energy[GZ_BINS]);
+
+/**
+ * @brief Energy ratio of one bin against another.
+ *
+ * @param energy Snapshot from GZ_Energies().
+ * @return energy[bin] / energy[ref] in Q8, saturated to 0xFFFF.
+ */
+uint16_t GZ_Ratio(const uint32_t energy[GZ_BINS], uint8_t bin, uint8_t ref);
+
+#endif // GOERTZEL_H
@@ -0,0 +1,48 @@
+/**
+ * @file platform.h
+ * @brief Interface between the portable detection/search logic and the hardware.
+ *
+ * The meter core, channel detector, video standard tracker and search FSM
+ * use only this interface and the APIs of the hardware modules
+ * (pulse_gen.h, buttons.h, events.h, FREQ_Init/Start/Stop). The firmware
+ * implements them with the HAL (platform_stm32.c and the hardware modules);
+ * a host build defines PLATFORM_HOST and links the Host/ backend instead,
+ * which runs the same logic on a virtual clock.
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef PLATFORM_HOST
+#include "platform_host.h"
+#else
+#include "main.h"
+/// Opens a section that interrupts cannot preempt; pair with PLAT_CRITICAL_EXIT() in the same scope
+#define PLAT_CRITICAL_ENTER() uint32_t _plat_primask = __get_PRIMASK(); __disable_irq()
+#define PLAT_CRITICAL_EXIT()  __set_PRIMASK(_plat_primask)
+#endif
+
+/**
+ * @brief Digital outputs driven by the search logic.
+ */
+typedef enum {
+    PLAT_OUT_CTRL_UP,   /**< Receiver channel-up line, active low open drain */
+    PLAT_OUT_CTRL_DWN,  /**< Receiver channel-down line, active low open drain */
+    PLAT_OUT_LED,       /**< Alarm LED */
+    PLAT_OUT_BUZZER     /**< Alarm buzzer */
+} PLAT_Output_t;
+
+/**
+ * @brief Milliseconds since start-up.
+ */
+uint32_t PLAT_GetTick(void);
+
+/**
+ * @brief Asserts or releases an output.
+ */
+void PLAT_SetOutput(PLAT_Output_t out, bool active);
+
+#endif // PLATFORM_H
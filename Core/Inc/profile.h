@@ -0,0 +1,37 @@
+/**
+ * @file profile.h
+ * @brief Cycle-count instrumentation based on the SysTick down-counter.
+ *
+ * SysTick is clocked from HCLK and reloads every millisecond, so the
+ * difference of two VAL readings is a CPU cycle count for sections shorter
+ * than 1 ms. Enabled only when FREQ_PROFILE is defined; otherwise the
+ * macros expand to nothing.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "platform.h"
+
+/**
+ * @brief Cycle statistics of one instrumented section.
+ */
+typedef struct {
+    uint32_t last;   /**< Cycles spent in the last run */
+    uint32_t max;    /**< Worst case since reset */
+} Profile_t;
+
+#ifdef FREQ_PROFILE
+#define PROF_START() uint32_t _prof_t0 = SysTick->VAL
+#define PROF_END(prof) do { \
+    uint32_t _prof_d = _prof_t0 - SysTick->VAL; \
+    if ((int32_t)_prof_d < 0) _prof_d += SysTick->LOAD + 1; \
+    (prof).last = _prof_d; \
+    if (_prof_d > (prof).max) (prof).max = _prof_d; \
+} while (0) ///< Stores elapsed cycles since PROF_START() in a Profile_t
+#else
+#define PROF_START()   do { } while (0)
+#define PROF_END(prof) do { } while (0)
+#endif
+
+#endif // PROFILE_H
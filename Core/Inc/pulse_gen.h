@@ -0,0 +1,56 @@
+/**
+ * @file pulse_gen.h
+ * @brief Timer-generated channel step pulses on the CTRL_UP/CTRL_DWN lines.
+ *
+ * TIM14 counts at PG_TICK_HZ; a pulse starts on the update event and ends
+ * on the channel 1 compare, so width and period are set by the timer rather
+ * than by main loop polling. CTRL_UP (PA3) has no timer alternate function
+ * on this package, so both lines are driven from the two interrupts; the
+ * only jitter left is interrupt latency, a few microseconds.
+ *
+ * Every completed pulse is counted and posted as EV_STEP.
+ */
+
+#ifndef PULSE_GEN_H
+#define PULSE_GEN_H
+
+#include "platform.h"
+
+#define PG_TICK_HZ      10000U  ///< Timer count rate, 0.1 ms resolution
+
+/**
+ * @brief Configures the timer and its interrupt. Does not start it.
+ * @param htim TIM14 handle.
+ */
+void PG_Init(TIM_HandleTypeDef* htim);
+
+/**
+ * @brief Emits a pulse now and then one every period_ms until PG_Stop().
+ *
+ * @param out Control line, PLAT_OUT_CTRL_UP or PLAT_OUT_CTRL_DWN.
+ * @param period_ms Pulse period, up to 6553 ms.
+ * @param width_ms Pulse width, below period_ms.
+ */
+void PG_Start(PLAT_Output_t out, uint16_t period_ms, uint16_t width_ms);
+
+/**
+ * @brief Emits a single pulse now.
+ */
+void PG_Step(PLAT_Output_t out, uint16_t width_ms);
+
+/**
+ * @brief Stops the pulse stream and releases the control line.
+ */
+void PG_Stop(void);
+
+/**
+ * @brief Pulses completed since the last PG_Start() or PG_Step().
+ */
+uint32_t PG_Steps(void);
+
+/**
+ * @brief Timer interrupt handler, call from TIM14_IRQHandler.
+ */
+void PG_IRQHandler(void);
+
+#endif // PULSE_GEN_H
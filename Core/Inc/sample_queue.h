@@ -0,0 +1,79 @@
+/**
+ * @file sample_queue.h
+ * @brief Lock-free single-producer/single-consumer queue of frequency samples.
+ *
+ * The ADC interrupt is the only producer and the main loop the only consumer.
+ * Each side writes only its own index, so no locking is needed on the
+ * single-core Cortex-M0; compiler barriers keep the slot write ordered
+ * before the index update.
+ */
+
+#ifndef SAMPLE_QUEUE_H
+#define SAMPLE_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SQ_SIZE     64      ///< Queue capacity, power of two not above 128
+#define SQ_MASK     (SQ_SIZE - 1)
+
+#define SQ_BARRIER() __asm volatile ("" ::: "memory")  ///< Compiler barrier, enough on a single core
+
+/**
+ * @brief Line frequency sample tagged with the channel epoch it was measured in.
+ */
+typedef struct {
+    uint16_t khz_q8;            /**< Line frequency, kHz Q8.8 */
+    uint8_t epoch;              /**< Meter epoch at measurement, see FREQ_NextEpoch() */
+} FreqSample_t;
+
+/**
+ * @brief Queue storage and indices.
+ *
+ * Indices run freely modulo 256 and are masked on access, so a full queue
+ * is distinguishable from an empty one without a spare slot.
+ */
+typedef struct {
+    volatile uint8_t head;      /**< Next slot to write, owned by the producer */
+    volatile uint8_t tail;      /**< Next slot to read, owned by the consumer */
+    uint16_t dropped;           /**< Samples rejected because the queue was full */
+    FreqSample_t data[SQ_SIZE];
+} SampleQueue_t;
+
+/**
+ * @brief Empties the queue. Call only while the producer is stopped.
+ */
+void SQ_Init(SampleQueue_t *q);
+
+/**
+ * @brief Appends a sample. Producer side, interrupt context.
+ *
+ * @return false if the queue was full and the sample was dropped.
+ */
+static inline bool SQ_Push(SampleQueue_t *q, FreqSample_t sample) {
+    uint8_t head = q->head;
+    if ((uint8_t)(head - q->tail) >= SQ_SIZE) {
+        q->dropped++;
+        return false;
+    }
+    q->data[head & SQ_MASK] = sample;
+    SQ_BARRIER();
+    q->head = head + 1;
+    return true;
+}
+
+/**
+ * @brief Number of queued samples. Valid on either side, may be stale by the other side's pending update.
+ */
+static inline uint8_t SQ_Count(const SampleQueue_t *q) {
+    return (uint8_t)(q->head - q->tail);
+}
+
+/**
+ * @brief Moves up to max samples into out, oldest first. Consumer side.
+ *
+ * @return Number of samples copied.
+ */
+uint8_t SQ_Drain(SampleQueue_t *q, FreqSample_t *out, uint8_t max);
+
+#endif // SAMPLE_QUEUE_H
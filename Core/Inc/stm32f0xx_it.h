@@ -53,6 +53,11 @@ void PendSV_Handler(void);
 void SysTick_Handler(void);
 void ADC1_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void DMA1_Channel1_IRQHandler(void);
+void TIM3_IRQHandler(void);
+void EXTI0_1_IRQHandler(void);
+void EXTI2_3_IRQHandler(void);
+void TIM14_IRQHandler(void);
 
 /* USER CODE END EFP */
 
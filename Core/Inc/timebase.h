@@ -0,0 +1,48 @@
+/**
+ * @file timebase.h
+ * @brief Free-running 32-bit timebase built on a 16-bit timer.
+ *
+ * The timer runs undivided from the core clock and its overflows are counted
+ * in software, giving one tick per CPU cycle with a ~89 s wrap at 48 MHz.
+ */
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include "main.h"
+
+/**
+ * @brief Configures the timer for the timebase. Does not start it.
+ * @param htim TIM3 handle, its update interrupt is used for overflow counting.
+ */
+void TB_Init(TIM_HandleTypeDef* htim);
+
+/**
+ * @brief Clears the overflow count and starts the timer.
+ */
+void TB_Start(void);
+
+/**
+ * @brief Stops the timer.
+ */
+void TB_Stop(void);
+
+/**
+ * @brief Returns the tick rate in Hz.
+ */
+uint32_t TB_GetRate(void);
+
+/**
+ * @brief Returns the overflow-extended tick count.
+ *
+ * Safe to call from any interrupt priority, including while the timer
+ * overflow interrupt is pending.
+ */
+uint32_t TB_Now(void);
+
+/**
+ * @brief Timer interrupt handler, call from the timer IRQ vector.
+ */
+void TB_IRQHandler(void);
+
+#endif // TIMEBASE_H
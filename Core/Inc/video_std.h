@@ -0,0 +1,87 @@
+/**
+ * @file video_std.h
+ * @brief Field structure check and PAL/NTSC discrimination from line sync periods.
+ *
+ * During the vertical interval the sync train runs at twice the line rate
+ * (equalising and broad pulses every half line), so the edge-to-edge
+ * periods the meter already measures switch from ~64 us to ~32 us once per
+ * field. Each run of half-line periods marks a field boundary. The time and
+ * the number of full lines between two boundaries tell a 50 Hz / 312.5 line
+ * field from a 60 Hz / 262.5 line one. Every period costs a few compares,
+ * the field check runs once per boundary.
+ *
+ * Consecutive fields of the same standard raise the confidence, a field that
+ * matches neither lowers it, and losing the field structure clears it.
+ */
+
+#ifndef VIDEO_STD_H
+#define VIDEO_STD_H
+
+#include <stdint.h>
+
+#define VS_TICKS_PER_US     48U     ///< Period units, same as FREQ_TICK_HZ
+#define VS_US(us)           ((uint32_t)((us) * VS_TICKS_PER_US))  ///< Microseconds to period units
+
+/**
+ * @defgroup VideoStdTiming Line and Field Timing
+ * @{
+ */
+#define VS_HALF_MIN         VS_US(28)       ///< Shortest half-line period (equalising/broad pulses)
+#define VS_HALF_MAX         VS_US(36)       ///< Longest half-line period
+#define VS_LINE_MIN         VS_US(60)       ///< Shortest full line period
+#define VS_LINE_MAX         VS_US(68)       ///< Longest full line period
+#define VS_PAL_FIELD        VS_US(20000)    ///< 50 Hz field
+#define VS_NTSC_FIELD       VS_US(16683)    ///< 59.94 Hz field
+#define VS_FIELD_TOL        VS_US(400)      ///< Allowed field period error (~2 %)
+#define VS_FIELD_TIMEOUT    VS_US(25000)    ///< No boundary for this long drops the field lock
+#define VS_PAL_LINES        305     ///< Full lines between vertical intervals, 312.5 - 7.5
+#define VS_NTSC_LINES       253     ///< Full lines between vertical intervals, 262.5 - 9
+#define VS_LINES_TOL        8       ///< Allowed line count error (missed or split edges)
+#define VS_MIN_HALVES       4       ///< Half-line periods in a row that make a field boundary
+#define VS_MAX_BAD          8       ///< Periods matching neither line nor half line allowed per field
+#define VS_CONF_MAX         15      ///< Confidence saturation, in consistent fields
+/** @} */
+
+/**
+ * @brief Detected video standard.
+ */
+typedef enum {
+    VS_UNKNOWN,     /**< No consistent field structure */
+    VS_PAL,         /**< 625 lines, 50 Hz fields */
+    VS_NTSC         /**< 525 lines, 60 Hz fields */
+} VS_Standard_t;
+
+/**
+ * @brief Field tracker state.
+ */
+typedef struct {
+    uint32_t field_ticks;       /**< Time since the last field boundary */
+    uint16_t lines;             /**< Full line periods since the last boundary */
+    uint8_t halves;             /**< Half-line periods in the current vertical interval */
+    uint8_t bad;                /**< Unclassified periods since the last boundary */
+    uint8_t in_vbi;             /**< 1 while inside a run of half-line periods */
+    uint8_t locked;             /**< 1 once a boundary has been seen and not timed out */
+    volatile uint8_t standard;  /**< Last detected VS_Standard_t */
+    volatile uint8_t confidence; /**< Consecutive fields agreeing with `standard`, 0..VS_CONF_MAX */
+} VideoStd_t;
+
+/**
+ * @brief Clears the tracker and the detected standard.
+ */
+void VS_Reset(VideoStd_t *vs);
+
+/**
+ * @brief Feeds one edge-to-edge period.
+ *
+ * @param period Period in VS_TICKS_PER_US units, as published by the meter before conversion.
+ */
+void VS_Edge(VideoStd_t *vs, uint32_t period);
+
+/**
+ * @brief Detected standard once at least `min_conf` consistent fields were seen.
+ */
+static inline VS_Standard_t VS_Get(const VideoStd_t *vs, uint8_t min_conf) {
+    return (vs->confidence >= min_conf) ? (VS_Standard_t)vs->standard : VS_UNKNOWN;
+}
+
+#endif // VIDEO_STD_H
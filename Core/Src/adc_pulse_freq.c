@@ -1,73 +1,218 @@
 #include "adc_pulse_freq.h"
-#define SAMPLING_TIME ((uint32_t)1e5) // 10 µs
-FrequencyMeter_t *_freq_meter;
 
 /**
- * @brief Initializes the ADC & TIM for signal sampling.
+ * @defgroup FreqRecipLut Period to Frequency Lookup
+ * @brief Compile-time table of FREQ_TICK_HZ / period in kHz Q8.8, linearly interpolated
+ *
+ * Covers periods from RECIP_P0 (25 kHz) in 32-tick steps up to
+ * ~9.7 kHz; rounding plus interpolation error stays within ~1 LSB (4 Hz).
+ * @{
  */
-void FREQ_Init(FrequencyMeter_t *freq_meter) {
-	freq_meter->hadc->Init.Resolution = ADC_RESOLUTION_8B;
-	freq_meter->hadc->Init.ContinuousConvMode = ENABLE;
-	freq_meter->hadc->Init.ExternalTrigConv = ADC_SOFTWARE_START;
-	freq_meter->hadc->Init.DataAlign = ADC_DATAALIGN_RIGHT;
-	freq_meter->hadc->Init.ScanConvMode = DISABLE;
-	HAL_ADC_Init(freq_meter->hadc);
-
-	ADC_ChannelConfTypeDef sConfig = { 0 };
-	sConfig.Channel = freq_meter->adcChannel;
-	sConfig.Rank = 1;
-	sConfig.SamplingTime = ADC_SAMPLETIME_55CYCLES_5;
-	HAL_ADC_ConfigChannel(freq_meter->hadc, &sConfig);
-
-	freq_meter->htim->Init.Prescaler = (SystemCoreClock / SAMPLING_TIME) - 1;
-	freq_meter->htim->Init.CounterMode = TIM_COUNTERMODE_UP;
-	freq_meter->htim->Init.Period = 0xFFFFFFFF;
-	HAL_TIM_Base_Init(freq_meter->htim);
-
-	_freq_meter = freq_meter;
+#define RECIP_P0       1920U    ///< First period in the table, ticks
+#define RECIP_STEP_SH  5        ///< log2 of the period step between entries
+#define RECIP_LEN      96       ///< Number of entries
+#define RECIP_NUM      ((FREQ_TICK_HZ / 1000U) << FREQ_Q8_SHIFT)
+#define RECIP(i)       ((RECIP_NUM + (RECIP_P0 + ((i) << RECIP_STEP_SH)) / 2) / (RECIP_P0 + ((i) << RECIP_STEP_SH))),
+#define RECIP4(i)      RECIP(i) RECIP((i) + 1) RECIP((i) + 2) RECIP((i) + 3)
+#define RECIP16(i)     RECIP4(i) RECIP4((i) + 4) RECIP4((i) + 8) RECIP4((i) + 12)
+#define RECIP32(i)     RECIP16(i) RECIP16((i) + 16)
+/** @} */
+
+static const uint16_t _recip_lut[RECIP_LEN] = { RECIP32(0) RECIP32(32) RECIP32(64) };
+
+void FREQ_Configure(FrequencyMeter_t *freq_meter, uint32_t tick_rate) {
+	freq_meter->_tick_rate = tick_rate;
+
+	if (freq_meter->mode == FREQ_MODE_DMA && freq_meter->goertzel) {
+		static const uint32_t bins[GZ_BINS] = { FREQ_GZ_PAL_HZ, FREQ_GZ_NTSC_HZ, FREQ_GZ_REF_HZ };
+		GZ_Init(&freq_meter->_gz, tick_rate, bins, FREQ_GZ_N);
+	}
+
+	// The only division on the period path, done once here instead of per edge
+	freq_meter->_period_scale = ((FREQ_TICK_HZ << FREQ_SCALE_SHIFT) + tick_rate / 2) / tick_rate;
+}
+
+void FREQ_Reset(FrequencyMeter_t *freq_meter) {
+	freq_meter->_triggered = 0;
+	freq_meter->_last_time = 0;
+	freq_meter->_pulse_width = 0;
+	freq_meter->_sync = (FREQ_SyncStats_t) { 0 };
+	freq_meter->_env_min = freq_meter->threshold_low << 8;
+	freq_meter->_env_max = freq_meter->threshold_high << 8;
+	freq_meter->_sample_idx = 0;
+	freq_meter->_rate_idx = 0;
+	freq_meter->_rate_tick = PLAT_GetTick();
 }
 
-void FREQ_Start(FrequencyMeter_t *freq_meter) {
-	HAL_ADC_Start_IT(freq_meter->hadc);
-	HAL_TIM_Base_Start(freq_meter->htim);
+uint32_t FREQ_GetSampleRate(const FrequencyMeter_t *freq_meter) {
+	return freq_meter->_tick_rate;
 }
 
-void FREQ_Stop(FrequencyMeter_t *freq_meter) {
-	HAL_ADC_Stop(freq_meter->hadc);
-	HAL_TIM_Base_Stop(freq_meter->htim);
+uint32_t FREQ_MeasureSampleRate(FrequencyMeter_t *freq_meter) {
+	uint32_t now = PLAT_GetTick();
+	uint32_t idx = freq_meter->_sample_idx;
+	uint32_t dt = now - freq_meter->_rate_tick;
+	uint32_t n = idx - freq_meter->_rate_idx;
+
+	if (dt == 0) return 0;
+	freq_meter->_rate_tick = now;
+	freq_meter->_rate_idx = idx;
+	return (n / dt) * 1000 + (n % dt) * 1000 / dt;
+}
+
+void FREQ_TakeSyncStats(FrequencyMeter_t *freq_meter, FREQ_SyncStats_t *stats) {
+	PLAT_CRITICAL_ENTER();
+	*stats = freq_meter->_sync;
+	freq_meter->_sync = (FREQ_SyncStats_t) { 0 };
+	PLAT_CRITICAL_EXIT();
+}
+
+uint16_t FREQ_GetToneRatio(const FrequencyMeter_t *freq_meter) {
+	uint32_t energy[GZ_BINS];
+	GZ_Energies(&freq_meter->_gz, energy);
+
+	uint16_t pal = GZ_Ratio(energy, FREQ_GZ_BIN_PAL, FREQ_GZ_BIN_REF);
+	uint16_t ntsc = GZ_Ratio(energy, FREQ_GZ_BIN_NTSC, FREQ_GZ_BIN_REF);
+	return (pal > ntsc) ? pal : ntsc;
 }
 
 /**
- * @brief ADC conversion complete callback with hysteresis.
- * @param hadc ADC handle pointer.
+ * @brief Converts a period to kHz Q8.8 without dividing.
+ * @param period Period in FREQ_TICK_HZ ticks.
+ * @return Frequency, 0xFFFF above and 0 below the table range.
  */
-void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc) {
-	if (hadc->Instance == ADC1) {
-		uint8_t value = hadc->Instance->DR;
-		uint32_t current_time = __HAL_TIM_GET_COUNTER(_freq_meter->htim);
+static inline uint16_t freq_period_to_q8(uint32_t period) {
+	if (period < RECIP_P0) return 0xFFFF;
+	uint32_t offset = period - RECIP_P0;
+	uint32_t idx = offset >> RECIP_STEP_SH;
+	if (idx >= RECIP_LEN - 1) return 0;
 
-		if (!_freq_meter->_triggered) {
-			if (value >= _freq_meter->threshold_high) {
-				_freq_meter->_triggered = 1; // Фиксируем срабатывание
+	uint32_t frac = offset & ((1U << RECIP_STEP_SH) - 1);
+	uint32_t f0 = _recip_lut[idx];
+	return f0 - (((f0 - _recip_lut[idx + 1]) * frac + (1U << (RECIP_STEP_SH - 1))) >> RECIP_STEP_SH);
+}
 
-				if (_freq_meter->_last_time != 0) {
-					value = SAMPLING_TIME / (current_time - _freq_meter->_last_time) / 1000; //In KHz
-					CB_Add(_freq_meter->frequency, (void*) &value);
+/**
+ * @brief Rescales a timestamp difference to FREQ_TICK_HZ ticks with one multiply.
+ * @return Ticks, clamped to FREQ_PERIOD_MAX.
+ */
+static inline uint32_t freq_to_ticks(const FrequencyMeter_t *freq_meter, uint32_t delta) {
+	if (delta > FREQ_PERIOD_MAX) delta = FREQ_PERIOD_MAX;
+	delta = (delta * freq_meter->_period_scale) >> FREQ_SCALE_SHIFT;
+	return (delta > FREQ_PERIOD_MAX) ? FREQ_PERIOD_MAX : delta;
+}
 
-				}
-				_freq_meter->_last_time = current_time;
-			}
-		} else {
-			if (value <= _freq_meter->threshold_low) {
-				_freq_meter->_triggered = 0; // Сброс триггера, ждем нового фронта
-			}
+/**
+ * @brief Checks a pulse phase against the sync width window.
+ */
+static inline uint8_t freq_sync_width_ok(const FrequencyMeter_t *freq_meter, uint32_t width) {
+	return (width >= freq_meter->sync_width_min) && (width <= freq_meter->sync_width_max);
+}
+
+void FREQ_OnRise(FrequencyMeter_t *freq_meter, uint32_t now) {
+	PROF_START();
+	if (freq_meter->_last_time != 0) {
+		uint32_t period = freq_to_ticks(freq_meter, now - freq_meter->_last_time);
+		FreqSample_t sample = { freq_period_to_q8(period), freq_meter->_epoch };
+
+		if (freq_meter->sync_width_min != 0) {
+			uint32_t width = freq_meter->_pulse_width;
+			uint8_t width_ok = freq_sync_width_ok(freq_meter, width) || (width < period && freq_sync_width_ok(freq_meter, period - width));
+			uint8_t period_ok = (period >= FREQ_SYNC_PERIOD_MIN) && (period <= FREQ_SYNC_PERIOD_MAX);
+
+			freq_meter->_sync.pulses++;
+			freq_meter->_sync.width_ok += width_ok;
+			freq_meter->_sync.period_ok += period_ok;
+			freq_meter->_sync.matched += width_ok & period_ok;
+			if (!width_ok) sample.khz_q8 = 0;
 		}
 
-		if ((current_time - _freq_meter->_last_time) > _freq_meter->_timeout) {
-			value = 0;
-			//CB_Add(_freq_meter->frequency, (void*) &value);
+		SQ_Push(freq_meter->frequency, sample);
+		if (SQ_Count(freq_meter->frequency) == FREQ_WAKE_LEVEL) EV_Post(EV_SAMPLES);
+		if (freq_meter->video != NULL) VS_Edge(freq_meter->video, period);
+	}
+	freq_meter->_last_time = now;
+	PROF_END(freq_meter->prof_edge);
+}
+
+void FREQ_OnFall(FrequencyMeter_t *freq_meter, uint32_t now) {
+	freq_meter->_pulse_width = freq_to_ticks(freq_meter, now - freq_meter->_last_time);
+}
+
+/**
+ * @brief Moves one envelope towards a block extreme.
+ *
+ * @param env Envelope, Q8.
+ * @param target Block extreme in ADC counts.
+ * @param widen true if reaching the target widens the envelope (attack).
+ */
+static inline uint16_t freq_env_step(uint16_t env, uint8_t target, uint8_t widen) {
+	int32_t diff = ((int32_t) target << 8) - env;
+	return env + (diff >> (widen ? FREQ_ENV_ATTACK_SHIFT : FREQ_ENV_DECAY_SHIFT));
+}
+
+/**
+ * @brief Tracks the sync tip and peak envelopes over a block and moves the hysteresis band.
+ *
+ * Probes every FREQ_ENV_STRIDE-th sample; the new thresholds apply from the
+ * next block on, so the comparator loop itself is unchanged.
+ *
+ * @param block First sample of the block.
+ * @param len Number of samples in the block.
+ */
+static void freq_track_envelope(FrequencyMeter_t *freq_meter, const uint8_t *block, uint32_t len) {
+	uint8_t lo = 0xFF;
+	uint8_t hi = 0;
+
+	for (uint32_t i = 0; i < len; i += FREQ_ENV_STRIDE) {
+		uint8_t value = block[i];
+		if (value < lo) lo = value;
+		if (value > hi) hi = value;
+	}
+
+	uint16_t env_min = freq_env_step(freq_meter->_env_min, lo, lo < (freq_meter->_env_min >> 8));
+	uint16_t env_max = freq_env_step(freq_meter->_env_max, hi, hi > (freq_meter->_env_max >> 8));
+	freq_meter->_env_min = env_min;
+	freq_meter->_env_max = env_max;
+
+	uint32_t span = (env_max > env_min) ? (uint32_t) (env_max - env_min) : 0;
+	if (span < (FREQ_ENV_MIN_SPAN << 8)) span = FREQ_ENV_MIN_SPAN << 8;
+	uint32_t high = (env_min + ((span * freq_meter->env_high_q8) >> 8)) >> 8;
+	uint32_t low = (env_min + ((span * freq_meter->env_low_q8) >> 8)) >> 8;
+	freq_meter->threshold_high = (high > 0xFF) ? 0xFF : high;
+	freq_meter->threshold_low = (low > 0xFE) ? 0xFE : low;
+}
+
+void FREQ_ProcessBlock(FrequencyMeter_t *freq_meter, const uint8_t *block, uint32_t len) {
+	const uint8_t high = freq_meter->threshold_high;
+	const uint8_t low = freq_meter->threshold_low;
+	uint8_t triggered = freq_meter->_triggered;
+	uint32_t t = freq_meter->_sample_idx;
+
+	for (uint32_t i = 0; i < len; i++) {
+		uint8_t value = block[i];
+		if (!triggered) {
+			if (value >= high) {
+				triggered = 1;
+				FREQ_OnRise(freq_meter, t + i);
+			}
+		} else if (value <= low) {
+			triggered = 0;
+			FREQ_OnFall(freq_meter, t + i);
 		}
+	}
+
+	freq_meter->_triggered = triggered;
+	freq_meter->_sample_idx = t + len;
 
-		HAL_ADC_Start_IT(hadc);
+	if (freq_meter->adaptive) {
+		freq_track_envelope(freq_meter, block, len);
+	}
+
+	if (freq_meter->goertzel) {
+		PROF_START();
+		GZ_Process(&freq_meter->_gz, block, len);
+		PROF_END(freq_meter->prof_goertzel);
 	}
 }
+
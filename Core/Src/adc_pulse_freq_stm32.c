@@ -0,0 +1,210 @@
+/**
+ * @file adc_pulse_freq_stm32.c
+ * @brief STM32 backend of the frequency meter: ADC, DMA, analog watchdog and timer setup.
+ *
+ * Feeds the portable meter core in adc_pulse_freq.c from the HAL callbacks.
+ */
+
+#include "adc_pulse_freq.h"
+#include "timebase.h"
+/// AWD thresholds are compared on the 12-bit left-aligned result, so 8-bit values are shifted by 4
+#define AWD_WINDOW(low, high) ((((uint32_t)(high) << 4) << ADC_TR1_HT1_Pos) | ((uint32_t)(low) << 4))
+static FrequencyMeter_t *_freq_meter;
+
+static inline uint8_t freq_timer_triggered(const FrequencyMeter_t *freq_meter) {
+	return (freq_meter->mode == FREQ_MODE_DMA) && (freq_meter->sample_rate != 0);
+}
+
+/**
+ * @brief Initializes the ADC & TIM for signal sampling.
+ */
+void FREQ_Init(FrequencyMeter_t *freq_meter) {
+	const uint8_t timer_trig = freq_timer_triggered(freq_meter);
+
+	freq_meter->hadc->Init.Resolution = ADC_RESOLUTION_8B;
+	freq_meter->hadc->Init.ContinuousConvMode = ENABLE;
+	freq_meter->hadc->Init.ExternalTrigConv = ADC_SOFTWARE_START;
+	freq_meter->hadc->Init.DataAlign = ADC_DATAALIGN_RIGHT;
+	freq_meter->hadc->Init.ScanConvMode = DISABLE;
+	if (freq_meter->mode == FREQ_MODE_DMA) {
+		freq_meter->hadc->Init.DMAContinuousRequests = ENABLE;
+		freq_meter->hadc->Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
+	} else if (freq_meter->mode == FREQ_MODE_AWD) {
+		// Nobody reads DR in this mode, let the ADC overwrite it
+		freq_meter->hadc->Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
+	}
+	if (timer_trig) {
+		freq_meter->hadc->Init.ContinuousConvMode = DISABLE;
+		freq_meter->hadc->Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T3_TRGO;
+		freq_meter->hadc->Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+	}
+	HAL_ADC_Init(freq_meter->hadc);
+
+	ADC_ChannelConfTypeDef sConfig = { 0 };
+	sConfig.Channel = freq_meter->adcChannel;
+	sConfig.Rank = 1;
+	sConfig.SamplingTime = ADC_SAMPLETIME_55CYCLES_5;
+	if (freq_meter->mode != FREQ_MODE_IT) {
+		// Conversions cost no CPU time here, so sample as fast as the ADC allows
+		sConfig.SamplingTime = FREQ_DMA_SAMPLETIME;
+	}
+
+	if (freq_meter->mode == FREQ_MODE_DMA) {
+		__HAL_RCC_DMA1_CLK_ENABLE();
+		freq_meter->hdma->Instance = DMA1_Channel1;
+		freq_meter->hdma->Init.Direction = DMA_PERIPH_TO_MEMORY;
+		freq_meter->hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+		freq_meter->hdma->Init.MemInc = DMA_MINC_ENABLE;
+		freq_meter->hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD; // DR low byte -> memory byte
+		freq_meter->hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+		freq_meter->hdma->Init.Mode = DMA_CIRCULAR;
+		freq_meter->hdma->Init.Priority = DMA_PRIORITY_HIGH;
+		HAL_DMA_Init(freq_meter->hdma);
+		__HAL_LINKDMA(freq_meter->hadc, DMA_Handle, *freq_meter->hdma);
+
+		HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+	}
+	HAL_ADC_ConfigChannel(freq_meter->hadc, &sConfig);
+
+	if (freq_meter->mode == FREQ_MODE_AWD) {
+		// Armed for the rising crossing: out of window once value >= threshold_high
+		ADC_AnalogWDGConfTypeDef sAwdConfig = { 0 };
+		sAwdConfig.WatchdogMode = ADC_ANALOGWATCHDOG_SINGLE_REG;
+		sAwdConfig.Channel = freq_meter->adcChannel;
+		sAwdConfig.ITMode = ENABLE;
+		sAwdConfig.HighThreshold = freq_meter->threshold_high - 1;
+		sAwdConfig.LowThreshold = 0;
+		HAL_ADC_AnalogWDGConfig(freq_meter->hadc, &sAwdConfig);
+	}
+
+	if (timer_trig) {
+		// One conversion per TIM update; round the divider up so the rate never exceeds the ADC limit
+		uint32_t rate = freq_meter->sample_rate;
+		if (rate > FREQ_MAX_SAMPLE_RATE) rate = FREQ_MAX_SAMPLE_RATE;
+		if (rate < FREQ_MIN_SAMPLE_RATE) rate = FREQ_MIN_SAMPLE_RATE;
+
+		freq_meter->htim->Init.Prescaler = 0;
+		freq_meter->htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+		freq_meter->htim->Init.Period = (SystemCoreClock + rate - 1) / rate - 1;
+		HAL_TIM_Base_Init(freq_meter->htim);
+
+		TIM_MasterConfigTypeDef sMasterConfig = { 0 };
+		sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+		sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+		HAL_TIMEx_MasterConfigSynchronization(freq_meter->htim, &sMasterConfig);
+
+		freq_meter->_tick_rate = SystemCoreClock / (freq_meter->htim->Init.Period + 1);
+	} else if (freq_meter->mode == FREQ_MODE_DMA) {
+		freq_meter->_tick_rate = FREQ_DMA_SAMPLE_RATE;
+	} else {
+		TB_Init(freq_meter->htim);
+		freq_meter->_tick_rate = TB_GetRate();
+	}
+
+	FREQ_Configure(freq_meter, freq_meter->_tick_rate);
+	_freq_meter = freq_meter;
+}
+
+void FREQ_Start(FrequencyMeter_t *freq_meter) {
+	FREQ_Reset(freq_meter);
+
+	if (freq_meter->mode == FREQ_MODE_DMA) {
+		HAL_ADC_Start_DMA(freq_meter->hadc, (uint32_t*) freq_meter->_dma_buf, FREQ_DMA_BUF_LEN);
+	} else if (freq_meter->mode == FREQ_MODE_AWD) {
+		freq_meter->hadc->Instance->TR = AWD_WINDOW(0, freq_meter->threshold_high - 1);
+		HAL_ADC_Start(freq_meter->hadc);
+	} else {
+		HAL_ADC_Start_IT(freq_meter->hadc);
+	}
+
+	if (freq_timer_triggered(freq_meter)) {
+		HAL_TIM_Base_Start(freq_meter->htim);
+	} else if (freq_meter->mode != FREQ_MODE_DMA) {
+		TB_Start();
+	}
+}
+
+void FREQ_Stop(FrequencyMeter_t *freq_meter) {
+	if (freq_meter->mode == FREQ_MODE_DMA) {
+		HAL_ADC_Stop_DMA(freq_meter->hadc);
+	} else {
+		// Also covers FREQ_MODE_AWD: AWDIE stays set and rearms on the next FREQ_Start
+		HAL_ADC_Stop(freq_meter->hadc);
+	}
+
+	if (freq_timer_triggered(freq_meter)) {
+		HAL_TIM_Base_Stop(freq_meter->htim);
+	} else if (freq_meter->mode != FREQ_MODE_DMA) {
+		TB_Stop();
+	}
+}
+
+/**
+ * @brief Analog watchdog callback: the signal has left the armed window.
+ *
+ * The window is flipped on every crossing, so it implements the same
+ * hysteresis as the software comparator with one interrupt per edge.
+ *
+ * @param hadc ADC handle pointer.
+ */
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc) {
+	if (hadc->Instance == ADC1) {
+		uint32_t current_time = TB_Now();
+
+		if (!_freq_meter->_triggered) {
+			// Rising crossing, wait for value <= threshold_low
+			hadc->Instance->TR = AWD_WINDOW(_freq_meter->threshold_low + 1, 0xFF);
+			_freq_meter->_triggered = 1;
+			FREQ_OnRise(_freq_meter, current_time);
+		} else {
+			// Falling crossing, wait for value >= threshold_high
+			hadc->Instance->TR = AWD_WINDOW(0, _freq_meter->threshold_high - 1);
+			_freq_meter->_triggered = 0;
+			FREQ_OnFall(_freq_meter, current_time);
+		}
+	}
+}
+
+/**
+ * @brief DMA half-transfer callback: first half of the buffer is ready.
+ * @param hadc ADC handle pointer.
+ */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc) {
+	if (hadc->Instance == ADC1) {
+		FREQ_ProcessBlock(_freq_meter, _freq_meter->_dma_buf, FREQ_DMA_BUF_LEN / 2);
+	}
+}
+
+/**
+ * @brief ADC conversion complete callback with hysteresis.
+ *
+ * In DMA mode this is the transfer-complete event for the second half of the buffer.
+ *
+ * @param hadc ADC handle pointer.
+ */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc) {
+	if (hadc->Instance == ADC1) {
+		if (_freq_meter->mode == FREQ_MODE_DMA) {
+			FREQ_ProcessBlock(_freq_meter, &_freq_meter->_dma_buf[FREQ_DMA_BUF_LEN / 2], FREQ_DMA_BUF_LEN / 2);
+			return;
+		}
+
+		uint8_t value = hadc->Instance->DR;
+		uint32_t current_time = TB_Now();
+
+		if (!_freq_meter->_triggered) {
+			if (value >= _freq_meter->threshold_high) {
+				_freq_meter->_triggered = 1; // Фиксируем срабатывание
+				FREQ_OnRise(_freq_meter, current_time);
+			}
+		} else {
+			if (value <= _freq_meter->threshold_low) {
+				_freq_meter->_triggered = 0; // Сброс триггера, ждем нового фронта
+				FREQ_OnFall(_freq_meter, current_time);
+			}
+		}
+
+		HAL_ADC_Start_IT(hadc);
+	}
+}
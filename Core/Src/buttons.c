@@ -0,0 +1,103 @@
+#include "buttons.h"
+#include "events.h"
+
+static volatile uint8_t _btn_armed;
+static volatile uint8_t _btn_state;
+static volatile uint8_t _btn_pressed;
+static volatile uint8_t _btn_released;
+static uint8_t _btn_count[2];
+
+/**
+ * @brief Raw button levels as a BTN_MASK_* set, pressed buttons pull the pin low.
+ */
+static inline uint8_t btn_raw(void) {
+	uint8_t raw = 0;
+	if ((BTN_P_GPIO_Port->IDR & BTN_P_Pin) == 0) raw |= BTN_MASK_P;
+	if ((BTN_M_GPIO_Port->IDR & BTN_M_Pin) == 0) raw |= BTN_MASK_M;
+	return raw;
+}
+
+void BTN_Init(void) {
+	GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+	GPIO_InitStruct.Pin = BTN_P_Pin | BTN_M_Pin;
+	GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+	GPIO_InitStruct.Pull = GPIO_PULLUP;
+	HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+	_btn_state = 0;
+	_btn_pressed = 0;
+	_btn_released = 0;
+	_btn_count[0] = 0;
+	_btn_count[1] = 0;
+	// A button held through reset is seen once the sampler settles
+	_btn_armed = 1;
+
+	HAL_NVIC_SetPriority(EXTI0_1_IRQn, 3, 0);
+	HAL_NVIC_EnableIRQ(EXTI0_1_IRQn);
+	HAL_NVIC_SetPriority(EXTI2_3_IRQn, 3, 0);
+	HAL_NVIC_EnableIRQ(EXTI2_3_IRQn);
+}
+
+void BTN_Tick(void) {
+	if (!_btn_armed) return;
+
+	uint8_t raw = btn_raw();
+	uint8_t state = _btn_state;
+	uint8_t pressed = 0;
+	uint8_t released = 0;
+
+	for (uint8_t i = 0; i < 2; i++) {
+		uint8_t mask = 1U << i;
+		if (raw & mask) {
+			if (_btn_count[i] < BTN_DEBOUNCE_MS && ++_btn_count[i] == BTN_DEBOUNCE_MS && !(state & mask)) {
+				state |= mask;
+				pressed |= mask;
+			}
+		} else {
+			if (_btn_count[i] > 0 && --_btn_count[i] == 0 && (state & mask)) {
+				state &= ~mask;
+				released |= mask;
+			}
+		}
+	}
+
+	_btn_state = state;
+	if (pressed | released) {
+		_btn_pressed |= pressed;
+		_btn_released |= released;
+		EV_Post(EV_BUTTON);
+	}
+	if (state == 0 && _btn_count[0] == 0 && _btn_count[1] == 0) {
+		_btn_armed = 0;
+	}
+}
+
+uint8_t BTN_State(void) {
+	return _btn_state;
+}
+
+uint8_t BTN_TakePressed(void) {
+	PLAT_CRITICAL_ENTER();
+	uint8_t pressed = _btn_pressed;
+	_btn_pressed = 0;
+	PLAT_CRITICAL_EXIT();
+	return pressed;
+}
+
+uint8_t BTN_TakeReleased(void) {
+	PLAT_CRITICAL_ENTER();
+	uint8_t released = _btn_released;
+	_btn_released = 0;
+	PLAT_CRITICAL_EXIT();
+	return released;
+}
+
+/**
+ * @brief EXTI callback: a button edge arms the debounce sampler.
+ * @param GPIO_Pin Pin that triggered the interrupt.
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+	if (GPIO_Pin & (BTN_P_Pin | BTN_M_Pin)) {
+		_btn_armed = 1;
+	}
+}
@@ -0,0 +1,124 @@
+#include "channel_detector.h"
+
+/**
+ * @brief log2 of an integer in Q8, by normalisation and repeated squaring.
+ *
+ * Used only at configuration time; exact to the last fraction bit. Zero
+ * saturates to log2(1) = 0 instead of minus infinity.
+ */
+static int32_t log2_q8(uint32_t x) {
+	if (x == 0) return 0;
+
+	int32_t n = 31;
+	while (!(x & 0x80000000U)) {
+		x <<= 1;
+		n--;
+	}
+
+	uint32_t y = x >> 16; // Mantissa in [1, 2), Q15
+	int32_t r = n << 8;
+	for (int32_t bit = 128; bit != 0; bit >>= 1) {
+		y = (y * y) >> 15;
+		if (y >= (2U << 15)) {
+			y >>= 1;
+			r += bit;
+		}
+	}
+	return r;
+}
+
+void CD_Init(ChannelDetector_t *cd, uint16_t min_val, uint16_t max_val, uint8_t len, uint8_t threshold) {
+	cd->min_val = min_val;
+	cd->max_val = max_val;
+	cd->len = (len > CD_MAX_WINDOW) ? CD_MAX_WINDOW : len;
+	cd->threshold = threshold;
+	cd->epoch = 0;
+	cd->llr_in = 0;
+	cd->llr_out = 0;
+	cd->llr_upper = 0;
+	cd->llr_lower = 0;
+	CD_Reset(cd);
+}
+
+void CD_InitSPRT(ChannelDetector_t *cd, uint16_t p_signal, uint16_t p_noise, uint16_t alpha, uint16_t beta) {
+	const uint32_t one = 1U << 16;
+
+	// Keep every probability and its complement non-zero
+	if (p_signal == 0) p_signal = 1;
+	if (p_noise == 0) p_noise = 1;
+	if (alpha == 0) alpha = 1;
+	if (beta == 0) beta = 1;
+
+	cd->llr_in = log2_q8(p_signal) - log2_q8(p_noise);
+	cd->llr_out = log2_q8(one - p_signal) - log2_q8(one - p_noise);
+	cd->llr_upper = log2_q8(one - beta) - log2_q8(alpha);   // Wald: log((1 - beta) / alpha)
+	cd->llr_lower = log2_q8(beta) - log2_q8(one - alpha);   // Wald: log(beta / (1 - alpha))
+	cd->llr = 0;
+}
+
+/**
+ * @brief Clears the history bits beyond the window length and recounts the window.
+ */
+static void cd_recount(ChannelDetector_t *cd) {
+	uint8_t words = (cd->len + 31) / 32;
+	uint8_t rem = cd->len % 32;
+	uint8_t count = 0;
+
+	if (rem != 0) cd->out_bits[words - 1] &= (1U << rem) - 1;
+	for (uint8_t w = 0; w < words; w++) {
+		count += CD_Popcount(cd->out_bits[w]);
+	}
+	cd->out_count = count;
+}
+
+void CD_Reset(ChannelDetector_t *cd) {
+	for (uint8_t w = 0; w < CD_WORDS; w++) {
+		cd->out_bits[w] = 0xFFFFFFFFU;
+	}
+	cd_recount(cd);
+	cd->llr = 0;
+}
+
+void CD_SetEpoch(ChannelDetector_t *cd, uint8_t epoch) {
+	cd->epoch = epoch;
+	CD_Reset(cd);
+}
+
+uint8_t CD_Add(ChannelDetector_t *cd, const FreqSample_t *samples, uint8_t count) {
+	uint8_t words = (cd->len + 31) / 32;
+	int32_t llr = cd->llr;
+	uint8_t accepted = 0;
+
+	while (count != 0) {
+		// Collect up to 31 current samples into a bit chunk, newest in bit 0, then shift it in
+		uint8_t n = (count > 31) ? 31 : count;
+		uint8_t k = 0;
+		uint32_t chunk = 0;
+
+		for (uint8_t i = 0; i < n; i++) {
+			if (samples[i].epoch != cd->epoch) continue;
+			uint32_t out = (samples[i].khz_q8 < cd->min_val) || (samples[i].khz_q8 > cd->max_val);
+			chunk = (chunk << 1) | out;
+			k++;
+
+			// Clamping at the bounds keeps the test responsive when the channel changes
+			llr += out ? cd->llr_out : cd->llr_in;
+			if (llr > cd->llr_upper) llr = cd->llr_upper;
+			if (llr < cd->llr_lower) llr = cd->llr_lower;
+		}
+
+		for (uint8_t w = 0; k != 0 && w < words; w++) {
+			uint32_t carry = cd->out_bits[w] >> (32 - k);
+			cd->out_bits[w] = (cd->out_bits[w] << k) | chunk;
+			chunk = carry;
+		}
+
+		samples += n;
+		count -= n;
+		accepted += k;
+	}
+
+	cd_recount(cd);
+	cd->llr = llr;
+	return accepted;
+}
@@ -0,0 +1,45 @@
+#include "events.h"
+
+volatile uint32_t ev_pending;
+
+static uint32_t _ev_iterations;
+static uint32_t _ev_idle_cycles;
+static uint32_t _ev_stats_tick;
+
+uint32_t EV_Wait(void) {
+	// Interrupts are enabled on entry, see events.h; no PRIMASK to restore
+	__disable_irq();
+#if EV_SLEEP
+	while (ev_pending == 0) {
+		// WFI also wakes on an interrupt masked by PRIMASK; the handler runs
+		// only after re-enabling, so the cycles counted here are pure sleep.
+		uint32_t t0 = SysTick->VAL;
+		__WFI();
+		uint32_t d = t0 - SysTick->VAL;
+		if ((int32_t) d < 0) d += SysTick->LOAD + 1;
+		_ev_idle_cycles += d;
+
+		__enable_irq();
+		__disable_irq();
+	}
+#endif
+	uint32_t events = ev_pending;
+	ev_pending = 0;
+	_ev_iterations++;
+	__enable_irq();
+	return events;
+}
+
+void EV_TakeStats(EV_Stats_t *stats) {
+	uint32_t now = HAL_GetTick();
+
+	PLAT_CRITICAL_ENTER();
+	stats->iterations = _ev_iterations;
+	stats->idle_cycles = _ev_idle_cycles;
+	_ev_iterations = 0;
+	_ev_idle_cycles = 0;
+	PLAT_CRITICAL_EXIT();
+
+	stats->cycles = (now - _ev_stats_tick) * (SysTick->LOAD + 1);
+	_ev_stats_tick = now;
+}
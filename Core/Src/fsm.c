@@ -5,18 +5,44 @@
 
 #include "fsm.h"
 #include "adc_pulse_freq.h"
+#include "channel_detector.h"
+#include "buttons.h"
+#include "pulse_gen.h"
 #include <stdbool.h>
 
 extern FrequencyMeter_t freq;
-extern TIM_HandleTypeDef htim1;
 
 /**
  * @defgroup SearchTiming Search Timing Parameters
  * @brief Timing parameters for channel search pulses
  * @{
  */
-#define PULSE_PERIOD_MS      700  ///< Time between search pulses in milliseconds
 #define PULSE_DURATION_MS    150   ///< Duration of each search pulse in milliseconds
+#define FAST_PULSE_MS        60    ///< Pulse width when stepping without listening
+#define FAST_PERIOD_MS       120   ///< Pulse period of back-to-back steps towards a target channel
+#define FAST_RELEASE_MS      (FAST_PERIOD_MS - FAST_PULSE_MS)  ///< Line release between back-to-back fast pulses
+#define BAND_CHANNELS        48    ///< Channels in the band; the index wraps after this many steps
+/** @} */
+
+/**
+ * @defgroup ChannelTable Channel Table Settings
+ * @brief Memory of what was found on each channel
+ * @{
+ */
+#define SKIP_CREDITS         3     ///< Passes an empty channel is skipped before it is checked again
+#define NO_CHANNEL           0xFF  ///< Channel index meaning "none"
+/** @} */
+
+/**
+ * @defgroup DwellTiming Adaptive Dwell Parameters
+ * @brief How long the search listens on each channel after its step pulse
+ * @{
+ */
+#define DWELL_SETTLE_MS      100   ///< Receiver settling after the pulse, samples are discarded
+#define DWELL_MIN_MS         20    ///< Shortest listening time before a CD_NOISE decision advances
+#define DWELL_QUIET_MS       30    ///< Advance when no edges at all arrived for this long
+#define DWELL_MAX_MS         700   ///< Longest listening time while the evidence stays undecided
+#define DWELL_FIELD_MS       120   ///< Listening time a CD_SIGNAL decision buys the field check, vertical intervals read as noise
 /** @} */
 
 /**
@@ -31,19 +57,38 @@ extern TIM_HandleTypeDef htim1;
 /**
  * @defgroup FrequencySettings Frequency Channel Settings
  * @brief Parameters for frequency channel detection
+ *
+ * Band, window and decision rule may come from svo_params.h, see adc_pulse_freq.h.
  * @{
  */
-#define FREQ_CH_MIN 14       ///< Minimum valid channel frequency value
-#define FREQ_CH_MAX 18       ///< Maximum valid channel frequency value
+#ifndef FREQ_CH_MIN
+#define FREQ_CH_MIN FREQ_KHZ_Q8(15.2)   ///< Minimum valid channel frequency value, kHz Q8.8
+#endif
+#ifndef FREQ_CH_MAX
+#define FREQ_CH_MAX FREQ_KHZ_Q8(16.2)   ///< Maximum valid channel frequency value, kHz Q8.8
+#endif
+#ifndef FREQ_CH_THR
 #define FREQ_CH_THR 5       ///< Maximum allowed out-of-range samples before channel is considered invalid
+#endif
+#ifndef FREQ_WINDOW_LEN
+#define FREQ_WINDOW_LEN 70  ///< Number of most recent samples evaluated for channel presence
+#endif
+#ifndef FREQ_CH_SEQUENTIAL
+#define FREQ_CH_SEQUENTIAL 1 ///< 1: the sequential test decides, 0: the out-of-range count over a full window
+#endif
+#define FIELD_MIN_CONF  2   ///< Consistent video fields required before alarming, 0 to skip the field check
+#define DETECTION_DEFAULTS { FREQ_CH_MIN, FREQ_CH_MAX, FREQ_WINDOW_LEN, FREQ_CH_THR, FIELD_MIN_CONF, FREQ_CH_SEQUENTIAL } ///< FSM_Detection_t of this build
 /** @} */
 
 /**
- * @defgroup ButtonSettings Button Settings
- * @brief Parameters for button debouncing
+ * @defgroup SprtSettings Sequential Detection Settings
+ * @brief Sample model and error rates for the sequential channel test
  * @{
  */
-#define DEBOUNCE_TIME_MS     10    ///< Debounce time for button presses in milliseconds
+#define SPRT_P_SIGNAL   CD_PROB_Q16(0.9)     ///< In-range probability of a sample on an occupied channel
+#define SPRT_P_NOISE    CD_PROB_Q16(0.2)     ///< In-range probability of a sample on an empty channel
+#define SPRT_ALPHA      CD_PROB_Q16(0.0001)  ///< Target false-alarm rate per decision
+#define SPRT_BETA       CD_PROB_Q16(0.001)   ///< Target miss rate per decision
 /** @} */
 
 /**
@@ -52,15 +97,16 @@ extern TIM_HandleTypeDef htim1;
  * @{
  */
 #define STOP_SEARCH() do { \
-    HAL_GPIO_WritePin(CTRL_UP_GPIO_Port, CTRL_UP_Pin, GPIO_PIN_SET); \
-    HAL_GPIO_WritePin(CTRL_DWN_GPIO_Port, CTRL_DWN_Pin, GPIO_PIN_SET); \
-} while(0) ///< Stops both search directions by setting control pins high
+    PG_Stop(); \
+    PLAT_SetOutput(PLAT_OUT_CTRL_UP, false); \
+    PLAT_SetOutput(PLAT_OUT_CTRL_DWN, false); \
+} while(0) ///< Stops both search directions by releasing the control lines
 
-#define LED_ON()    HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_2)  ///< Turns LED on by starting PWM
-#define LED_OFF()   HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_2)   ///< Turns LED off by stopping PWM
+#define LED_ON()    PLAT_SetOutput(PLAT_OUT_LED, true)      ///< Turns LED on
+#define LED_OFF()   PLAT_SetOutput(PLAT_OUT_LED, false)     ///< Turns LED off
 
-#define BUZZER_ON() HAL_TIMEx_PWMN_Start(&htim1, TIM_CHANNEL_1)  ///< Turns buzzer on by starting complementary PWM
-#define BUZZER_OFF() HAL_TIMEx_PWMN_Stop(&htim1, TIM_CHANNEL_1)  ///< Turns buzzer off by stopping complementary PWM
+#define BUZZER_ON() PLAT_SetOutput(PLAT_OUT_BUZZER, true)   ///< Turns buzzer on
+#define BUZZER_OFF() PLAT_SetOutput(PLAT_OUT_BUZZER, false) ///< Turns buzzer off
 /** @} */
 
 /**
@@ -70,62 +116,109 @@ typedef enum {
     IDLE,         /**< System is idle, waiting for button press */
     SEARCH_UP,    /**< Searching upward direction */
     SEARCH_DOWN,  /**< Searching downward direction */
-    ALARM         /**< Alarm state, channel found */
+    ALARM,        /**< Alarm state, channel found */
+    GOTO          /**< Stepping straight to a target channel */
 } State_t;
 
+/**
+ * @brief What is known about a channel.
+ */
+typedef enum {
+    CH_UNKNOWN,   /**< Never decided */
+    CH_EMPTY,     /**< Decided empty, skipped while credits remain */
+    CH_HIT        /**< A video signal was found here */
+} ChannelState_t;
+
+/**
+ * @brief Channel table entry.
+ */
+typedef struct {
+    uint8_t state : 2;          /**< ChannelState_t */
+    uint8_t credits : 6;        /**< Remaining skips of an empty channel */
+} ChannelEntry_t;
+
+/**
+ * @brief Phases of the dwell on one channel during a search.
+ */
+typedef enum {
+    DWELL_STEPPING,   /**< Step pulse in progress */
+    DWELL_RELEASING,  /**< Line released after a skip pulse, before the next one */
+    DWELL_SETTLING,   /**< Waiting for the receiver to retune */
+    DWELL_LISTENING   /**< Gathering evidence for the channel */
+} Dwell_t;
+
 /**
  * @brief FSM runtime context.
  */
 typedef struct {
     State_t current;            /**< Current FSM state */
     State_t last;               /**< Last processed FSM state */
-    uint32_t pulseTick;         /**< Timestamp for pulse generation */
-    uint32_t alarmCoolDown;		/**< Cooldown for Alarm system to avoid loop in SERCH-ALARM */
-    bool pulseActive;           /**< Flag indicating active pulse */
     uint32_t alarmTick;         /**< Timestamp for alarm blinking */
     bool alarmOn;               /**< Alarm blinking state flag */
-    bool waitForRelease;        /**< Prevents immediate state transition due to held button */
+    uint8_t pressed;            /**< Buttons pressed since the previous step, BTN_MASK_* */
+    ChannelDetector_t detector; /**< Channel presence over the latest samples, owned by the main loop */
+    VS_Standard_t found;        /**< Video standard of the last alarm */
+    PLAT_Output_t stepOut;      /**< Control line of the current search direction */
+    int8_t stepDir;             /**< +1 up, -1 down */
+    bool holdStep;              /**< Next search starts listening on the current channel */
+    uint8_t channel;            /**< Channel index relative to the power-on position */
+    uint8_t lastHit;            /**< Channel of the last alarm, NO_CHANNEL if none */
+    uint8_t target;             /**< GOTO destination */
+    uint8_t gotoSteps;          /**< Steps GOTO has to make */
+    uint8_t chord;              /**< Buttons pressed together in IDLE, acted on at release */
+    ChannelEntry_t table[BAND_CHANNELS]; /**< Per-channel search results */
+    Dwell_t dwell;              /**< Dwell phase on the current channel */
+    uint32_t dwellTick;         /**< Start of the current dwell phase */
+    uint16_t dwellSamples;      /**< Current-epoch samples received while listening */
+    bool dwellSignal;           /**< Detector decided CD_SIGNAL since listening started */
+    uint8_t sweepSteps;         /**< Steps taken in the current sweep */
+    uint32_t sweepTick;         /**< Start of the current sweep */
+    uint32_t sweepMs;           /**< Duration of the last complete sweep, 0 if none yet */
 } FSM_Context_t;
 
 static FSM_Context_t fsm = {0};
 
+static FSM_Detection_t detection = DETECTION_DEFAULTS;
+
 /**
- * @brief Debounced GPIO input checker.
+ * @brief Feeds all queued frequency samples to the channel detector.
  *
- * @param port GPIO port.
- * @param pin GPIO pin.
- * @return true if button is pressed and stable, false otherwise.
+ * The detector is only touched from the main loop, so its window is never
+ * seen half-updated.
  */
-static inline bool IsButtonPressed(GPIO_TypeDef *port, uint16_t pin) {
-    if ((port->IDR & pin) == 0) {
-        uint32_t t_start = HAL_GetTick();
-        while ((HAL_GetTick() - t_start) < DEBOUNCE_TIME_MS) {
-            if ((port->IDR & pin) != 0) return false;
-        }
-        return true;
+static void drain_samples(void) {
+    FreqSample_t batch[16];
+    uint8_t n;
+    while ((n = SQ_Drain(freq.frequency, batch, sizeof(batch) / sizeof(batch[0]))) != 0) {
+        fsm.dwellSamples += CD_Add(&fsm.detector, batch, n);
     }
-    return false;
 }
 
 /**
- * @brief Checks if frequency buffer meets channel presence conditions.
+ * @brief Checks that the line rate signal also carries a video field structure.
  *
- * @param buffer Pointer to circular buffer.
- * @param min_val Minimum valid frequency.
- * @param max_val Maximum valid frequency.
- * @param threshold Max allowed number of out-of-range values.
- * @return true if channel is detected, false otherwise.
+ * @param std Receives the detected standard.
+ * @return true if the field check passed or is disabled.
  */
-bool CheckForChannel(const CircularBuffer *buffer, uint8_t min_val, uint8_t max_val, uint8_t threshold) {
-    uint8_t out_of_range_count = 0;
-    uint8_t *data = (uint8_t *)buffer->data;
-    for (uint8_t i = 0; i < buffer->size; i++) {
-        if (data[i] < min_val || data[i] > max_val) {
-            out_of_range_count++;
-            if (out_of_range_count > threshold) return false;
-        }
-    }
-    return true;
+static bool field_confirmed(VS_Standard_t *std) {
+    *std = (freq.video != NULL) ? VS_Get(freq.video, detection.field_min_conf) : VS_UNKNOWN;
+    return detection.field_min_conf == 0 || freq.video == NULL || *std != VS_UNKNOWN;
+}
+
+/**
+ * @brief Channel decision from the out-of-band count once a full window is in.
+ */
+static CD_Decision_t window_decide(void) {
+    if (CD_IsPresent(&fsm.detector)) return CD_SIGNAL;
+    return (fsm.dwellSamples >= detection.window_len) ? CD_NOISE : CD_UNDECIDED;
+}
+
+void FSM_DefaultDetection(FSM_Detection_t *d) {
+    *d = (FSM_Detection_t) DETECTION_DEFAULTS;
+}
+
+void FSM_SetDetection(const FSM_Detection_t *d) {
+    detection = *d;
 }
 
 /**
@@ -133,105 +226,243 @@ bool CheckForChannel(const CircularBuffer *buffer, uint8_t min_val, uint8_t max_
  */
 void FSM_Init(void) {
     STOP_SEARCH();
+    fsm = (FSM_Context_t) {0};
     fsm.current = IDLE;
     fsm.last = IDLE;
-    fsm.pulseActive = false;
-    fsm.alarmOn = false;
-    fsm.waitForRelease = false;
+    fsm.lastHit = NO_CHANNEL;
+    CD_Init(&fsm.detector, detection.ch_min, detection.ch_max, detection.window_len, detection.ch_thr);
+    CD_InitSPRT(&fsm.detector, SPRT_P_SIGNAL, SPRT_P_NOISE, SPRT_ALPHA, SPRT_BETA);
 }
 
 /**
- * @brief IDLE state: wait for debounced button press.
+ * @brief IDLE state: wait for a debounced button press.
  */
 static void idle_state(void) {
     if (fsm.current != fsm.last) {
         fsm.last = fsm.current;
         STOP_SEARCH();
-        fsm.waitForRelease = true;
+        fsm.chord = 0;
     }
 
-    // Hold in IDLE until all buttons are released
-    if (fsm.waitForRelease) {
-        if (!IsButtonPressed(BTN_P_GPIO_Port, BTN_P_Pin) &&
-            !IsButtonPressed(BTN_M_GPIO_Port, BTN_M_Pin)) {
-            fsm.waitForRelease = false;
-        } else {
-            return;
-        }
-    }
+    // Collect the buttons of a new press until all are released; a button
+    // held over from the previous state does not count as a press
+    fsm.chord |= fsm.pressed;
+    if (fsm.chord == 0) return;
+    fsm.chord |= BTN_State();
+    if (BTN_State() != 0) return;
 
-    // Start appropriate search on button press
-    if (IsButtonPressed(BTN_P_GPIO_Port, BTN_P_Pin)) {
+    if (fsm.chord == (BTN_MASK_P | BTN_MASK_M)) {
+        if (fsm.lastHit != NO_CHANNEL) {
+            fsm.target = fsm.lastHit;
+            fsm.current = GOTO;
+        }
+    } else if (fsm.chord & BTN_MASK_P) {
         fsm.current = SEARCH_UP;
-    } else if (IsButtonPressed(BTN_M_GPIO_Port, BTN_M_Pin)) {
+    } else {
         fsm.current = SEARCH_DOWN;
     }
+    fsm.chord = 0;
+}
+
+/**
+ * @brief Channel index one step away, wrapping at the band edges.
+ */
+static uint8_t channel_after(uint8_t channel, int8_t dir) {
+    if (dir > 0) {
+        return (channel + 1 >= BAND_CHANNELS) ? 0 : channel + 1;
+    }
+    return (channel == 0) ? BAND_CHANNELS - 1 : channel - 1;
+}
+
+/**
+ * @brief Records the search result for the current channel.
+ */
+static void mark_channel(ChannelState_t state) {
+    fsm.table[fsm.channel].state = state;
+    fsm.table[fsm.channel].credits = (state == CH_EMPTY) ? SKIP_CREDITS : 0;
+}
+
+/**
+ * @brief Emits the step pulse to the next channel and restarts the dwell.
+ *
+ * The index moves when the pulse is issued; a pulse cut short by leaving
+ * the search may leave it one channel off.
+ *
+ * @param width_ms Pulse width.
+ */
+static void step_channel(uint16_t width_ms) {
+    uint32_t now = PLAT_GetTick();
+
+    // A sweep is complete when the step after its last channel starts
+    if (fsm.sweepSteps == BAND_CHANNELS) {
+        fsm.sweepMs = now - fsm.sweepTick;
+        fsm.sweepSteps = 0;
+    }
+    if (fsm.sweepSteps++ == 0) {
+        fsm.sweepTick = now;
+    }
+
+    FREQ_NextEpoch(&freq);
+    PG_Step(fsm.stepOut, width_ms);
+    fsm.channel = channel_after(fsm.channel, fsm.stepDir);
+    fsm.dwell = DWELL_STEPPING;
+    fsm.dwellTick = now;
 }
 
 /**
- * @brief Common logic for SEARCH states with timed pulse and channel detection.
+ * @brief Common logic for SEARCH states: stepping, settling and listening on each channel.
+ *
+ * An empty channel is left as soon as the detector decides CD_NOISE or no
+ * edges arrive at all; only undecided evidence keeps the search listening,
+ * up to DWELL_MAX_MS. Channels found empty on earlier passes are stepped
+ * over with short pulses, FAST_RELEASE_MS apart, while their skip credits last.
  *
- * @param port GPIO port to control.
- * @param pin GPIO pin to pulse.
  * @param opposite_pressed true if the opposite direction button is pressed.
  */
-static void handle_search(GPIO_TypeDef* port, uint16_t pin, bool opposite_pressed) {
-    uint32_t now = HAL_GetTick();
+static void handle_search(bool opposite_pressed) {
+    uint32_t now = PLAT_GetTick();
+    uint32_t elapsed = now - fsm.dwellTick;
 
-    if (!fsm.pulseActive && (now - fsm.pulseTick >= PULSE_PERIOD_MS)) {
-        HAL_GPIO_WritePin(port, pin, GPIO_PIN_RESET);
-        fsm.pulseTick = now;
-        fsm.pulseActive = true;
+    if (opposite_pressed) {
+        fsm.current = IDLE;
+        return;
     }
 
-    if (fsm.pulseActive && (now - fsm.pulseTick >= PULSE_DURATION_MS)) {
-        HAL_GPIO_WritePin(port, pin, GPIO_PIN_SET);
-        fsm.pulseActive = false;
+    switch (fsm.dwell) {
+        case DWELL_STEPPING:
+            if (PG_Steps() != 0) {
+                ChannelEntry_t *entry = &fsm.table[fsm.channel];
+                fsm.dwell = (entry->state == CH_EMPTY && entry->credits != 0) ? DWELL_RELEASING : DWELL_SETTLING;
+                fsm.dwellTick = now;
+            }
+            break;
+        case DWELL_RELEASING:
+            // A pulse right after the release reads as one long press to the receiver
+            if (elapsed >= FAST_RELEASE_MS) {
+                fsm.table[fsm.channel].credits--;
+                step_channel(FAST_PULSE_MS);
+            }
+            break;
+        case DWELL_SETTLING:
+            if (elapsed >= DWELL_SETTLE_MS) {
+                // Only samples measured from here on describe the new channel
+                CD_SetEpoch(&fsm.detector, FREQ_NextEpoch(&freq));
+                fsm.dwell = DWELL_LISTENING;
+                fsm.dwellTick = now;
+                fsm.dwellSamples = 0;
+                fsm.dwellSignal = false;
+            }
+            break;
+        case DWELL_LISTENING: {
+            CD_Decision_t decision = detection.sequential ? CD_Decide(&fsm.detector) : window_decide();
+            // The field tracker was cleared with the epoch; a line rate signal
+            // keeps the channel until it has seen enough fields to judge
+            if (decision == CD_SIGNAL) fsm.dwellSignal = true;
+            if (fsm.dwellSignal && field_confirmed(&fsm.found)) {
+                mark_channel(CH_HIT);
+                fsm.lastHit = fsm.channel;
+                fsm.current = ALARM;
+            } else if ((decision == CD_NOISE && elapsed >= (fsm.dwellSignal ? DWELL_FIELD_MS : DWELL_MIN_MS)) ||
+                       (fsm.dwellSamples == 0 && elapsed >= DWELL_QUIET_MS)) {
+                mark_channel(CH_EMPTY);
+                step_channel(PULSE_DURATION_MS);
+            } else if (elapsed >= DWELL_MAX_MS) {
+                mark_channel(CH_UNKNOWN);
+                step_channel(PULSE_DURATION_MS);
+            }
+            break;
+        }
     }
+}
 
-    if (now >= fsm.alarmCoolDown && CheckForChannel(freq.frequency, FREQ_CH_MIN, FREQ_CH_MAX, FREQ_CH_THR)) {
-        fsm.current = ALARM;
-    } else if (opposite_pressed) {
-        fsm.current = IDLE;
+/**
+ * @brief Enters a search direction with a step to the next channel.
+ *
+ * After GOTO the first step is skipped and the search listens on the
+ * channel it arrived at.
+ */
+static void start_search(PLAT_Output_t out, int8_t dir) {
+    STOP_SEARCH();
+    fsm.stepOut = out;
+    fsm.stepDir = dir;
+    fsm.sweepSteps = 0;
+    if (fsm.holdStep) {
+        fsm.holdStep = false;
+        fsm.dwell = DWELL_SETTLING;
+        fsm.dwellTick = PLAT_GetTick();
+    } else {
+        step_channel(PULSE_DURATION_MS);
     }
 }
 
 /**
- * @brief SEARCH_UP state: perform timed pulses and check for channel.
+ * @brief SEARCH_UP state: step upward and check for channel.
  */
 static void search_up_state(void) {
     if (fsm.current != fsm.last) {
         fsm.last = fsm.current;
-        STOP_SEARCH();
-        fsm.pulseTick = HAL_GetTick();
-        fsm.pulseActive = false;
+        start_search(PLAT_OUT_CTRL_UP, 1);
     }
 
-    handle_search(CTRL_UP_GPIO_Port, CTRL_UP_Pin, IsButtonPressed(BTN_M_GPIO_Port, BTN_M_Pin));
+    handle_search(fsm.pressed & BTN_MASK_M);
 }
 
 /**
- * @brief SEARCH_DOWN state: perform timed pulses and check for channel.
+ * @brief SEARCH_DOWN state: step downward and check for channel.
  */
 static void search_down_state(void) {
+    if (fsm.current != fsm.last) {
+        fsm.last = fsm.current;
+        start_search(PLAT_OUT_CTRL_DWN, -1);
+    }
+
+    handle_search(fsm.pressed & BTN_MASK_P);
+}
+
+/**
+ * @brief GOTO state: back-to-back fast pulses straight to the target channel, then listen there.
+ *
+ * Takes the shorter way round the band. A button press aborts to IDLE.
+ */
+static void goto_state(void) {
     if (fsm.current != fsm.last) {
         fsm.last = fsm.current;
         STOP_SEARCH();
-        fsm.pulseTick = HAL_GetTick();
-        fsm.pulseActive = false;
+
+        uint8_t up = (fsm.target + BAND_CHANNELS - fsm.channel) % BAND_CHANNELS;
+        fsm.stepDir = (up <= BAND_CHANNELS / 2) ? 1 : -1;
+        fsm.gotoSteps = (fsm.stepDir > 0) ? up : BAND_CHANNELS - up;
+        if (fsm.gotoSteps != 0) {
+            FREQ_NextEpoch(&freq);
+            PG_Start((fsm.stepDir > 0) ? PLAT_OUT_CTRL_UP : PLAT_OUT_CTRL_DWN, FAST_PERIOD_MS, FAST_PULSE_MS);
+        }
     }
 
-    handle_search(CTRL_DWN_GPIO_Port, CTRL_DWN_Pin, IsButtonPressed(BTN_P_GPIO_Port, BTN_P_Pin));
+    uint32_t done = (fsm.gotoSteps != 0) ? PG_Steps() : 0;
+    if (fsm.pressed) {
+        STOP_SEARCH();
+        while (done-- != 0) {
+            fsm.channel = channel_after(fsm.channel, fsm.stepDir);
+        }
+        fsm.current = IDLE;
+    } else if (done >= fsm.gotoSteps) {
+        // Stop before the next pulse starts, FAST_RELEASE_MS away
+        STOP_SEARCH();
+        fsm.channel = fsm.target;
+        fsm.holdStep = true;
+        fsm.current = (fsm.stepDir > 0) ? SEARCH_UP : SEARCH_DOWN;
+    }
 }
 
 /**
  * @brief ALARM state: blink LED and buzzer until any button pressed.
  */
 static void alarm_state(void) {
-    uint32_t now = HAL_GetTick();
+    uint32_t now = PLAT_GetTick();
 
     if (fsm.current != fsm.last) {
         fsm.last = fsm.current;
+        STOP_SEARCH();
         fsm.alarmTick = now;
         fsm.alarmOn = false;
         LED_OFF();
@@ -249,15 +480,14 @@ static void alarm_state(void) {
         fsm.alarmOn = false;
     }
 
-    if (IsButtonPressed(BTN_P_GPIO_Port, BTN_P_Pin) || IsButtonPressed(BTN_M_GPIO_Port, BTN_M_Pin)) {
+    if (fsm.pressed) {
         LED_OFF();
         BUZZER_OFF();
         fsm.alarmOn = false;
-        fsm.alarmCoolDown = now + 2*PULSE_PERIOD_MS;
         // Start appropriate search on button press
-        if (IsButtonPressed(BTN_P_GPIO_Port, BTN_P_Pin)) {
+        if (fsm.pressed & BTN_MASK_P) {
             fsm.current = SEARCH_UP;
-        } else if (IsButtonPressed(BTN_M_GPIO_Port, BTN_M_Pin)) {
+        } else {
             fsm.current = SEARCH_DOWN;
         }
     }
@@ -267,6 +497,9 @@ static void alarm_state(void) {
  * @brief Main FSM step function. Should be called periodically.
  */
 void FSM_Process(void) {
+    drain_samples();
+    fsm.pressed = BTN_TakePressed();
+
     switch (fsm.current) {
         case IDLE:
             idle_state();
@@ -280,5 +513,24 @@ void FSM_Process(void) {
         case ALARM:
             alarm_state();
             break;
+        case GOTO:
+            goto_state();
+            break;
     }
 }
+
+uint32_t FSM_GetSweepTime(void) {
+    return fsm.sweepMs;
+}
+
+uint8_t FSM_GetChannel(void) {
+    return fsm.channel;
+}
+
+bool FSM_InAlarm(void) {
+    return fsm.current == ALARM;
+}
+
+VS_Standard_t FSM_GetStandard(void) {
+    return fsm.found;
+}
@@ -0,0 +1,117 @@
+#include "goertzel.h"
+
+/**
+ * @brief cos() of an angle given in turns, Q16 in, Q14 out.
+ *
+ * Quadrant reduction plus a Taylor series to x^8; error is below 1 LSB.
+ * Used only at configuration time.
+ */
+static int32_t cos_q14(uint32_t turn_q16) {
+	turn_q16 &= 0xFFFF;
+	int32_t sign = 1;
+	if (turn_q16 > 0x8000) turn_q16 = 0x10000 - turn_q16;   // cos(-x) = cos(x)
+	if (turn_q16 > 0x4000) {                                 // cos(pi - x) = -cos(x)
+		turn_q16 = 0x8000 - turn_q16;
+		sign = -1;
+	}
+
+	int32_t x = (int32_t)((turn_q16 * 102944U) >> 16);  // Radians in Q14, 102944 = 2*pi in Q14
+	int32_t x2 = (x * x) >> 14;
+	// 1 - x^2/2 + x^4/24 - x^6/720 + x^8/40320, Horner form
+	int32_t r = (1 << 14) - ((x2 * ((1 << 14) - ((x2 * ((1 << 14) - ((x2 * ((1 << 14) - x2 / 56)) >> 14) / 30)) >> 14) / 12)) >> 14) / 2;
+	return sign * r;
+}
+
+void GZ_Init(Goertzel_t *gz, uint32_t sample_rate, const uint32_t freqs_hz[GZ_BINS], uint16_t n) {
+	uint32_t fs = sample_rate / GZ_DECIM;
+
+	for (uint8_t b = 0; b < GZ_BINS; b++) {
+		uint32_t turn_q16 = (uint32_t)(((uint64_t)freqs_hz[b] << 16) / fs);
+		gz->coeff[b] = 2 * cos_q14(turn_q16);
+		gz->s1[b] = 0;
+		gz->s2[b] = 0;
+		gz->energy[b] = 0;
+	}
+	gz->n = n;
+	gz->count = 0;
+	gz->acc = 0;
+	gz->acc_count = 0;
+	gz->seq = 0;
+}
+
+/**
+ * @brief (coeff * s) >> 14 exactly in 32-bit arithmetic.
+ *
+ * Splitting s into 16-bit halves keeps both products inside int32 for
+ * |coeff| < 2^15, avoiding a 64-bit multiply on the Cortex-M0.
+ */
+static inline int32_t gz_mul(int32_t coeff, int32_t s) {
+	int32_t hi = s >> 16;
+	uint32_t lo = (uint32_t)s & 0xFFFF;
+	return ((coeff * hi) << (16 - GZ_COEFF_SHIFT)) + ((coeff * (int32_t)lo) >> GZ_COEFF_SHIFT);
+}
+
+/**
+ * @brief Latches bin energies and restarts the evaluation.
+ */
+static void gz_finish(Goertzel_t *gz) {
+	for (uint8_t b = 0; b < GZ_BINS; b++) {
+		int64_t s1 = gz->s1[b];
+		int64_t s2 = gz->s2[b];
+		int64_t e = s1 * s1 + s2 * s2 - ((gz->coeff[b] * s1 * s2) >> GZ_COEFF_SHIFT);
+		gz->energy[b] = (e < 0) ? 0 : (uint32_t)(e >> GZ_ENERGY_SHIFT);
+		gz->s1[b] = 0;
+		gz->s2[b] = 0;
+	}
+	gz->count = 0;
+	gz->seq++;
+}
+
+void GZ_Process(Goertzel_t *gz, const uint8_t *samples, uint32_t len) {
+	int32_t acc = gz->acc;
+	uint32_t acc_count = gz->acc_count;
+	uint32_t i = 0;
+
+	while (i < len) {
+		// Tight summing loop for the current decimated sample
+		uint32_t take = GZ_DECIM - acc_count;
+		if (take > len - i) take = len - i;
+		for (uint32_t end = i + take; i < end; i++) {
+			acc += samples[i];
+		}
+		acc_count += take;
+		if (acc_count < GZ_DECIM) break;
+
+		int32_t x = acc - 128 * GZ_DECIM; // Remove the mid-scale offset
+		acc = 0;
+		acc_count = 0;
+
+		for (uint8_t b = 0; b < GZ_BINS; b++) {
+			int32_t s0 = x + gz_mul(gz->coeff[b], gz->s1[b]) - gz->s2[b];
+			gz->s2[b] = gz->s1[b];
+			gz->s1[b] = s0;
+		}
+		if (++gz->count >= gz->n) gz_finish(gz);
+	}
+
+	gz->acc = acc;
+	gz->acc_count = acc_count;
+}
+
+void GZ_Energies(const Goertzel_t *gz, uint32_t energy[GZ_BINS]) {
+	uint8_t seq;
+	do {
+		seq = gz->seq;
+		GZ_BARRIER();
+		for (uint8_t b = 0; b < GZ_BINS; b++) {
+			energy[b] = gz->energy[b];
+		}
+		GZ_BARRIER();
+	} while (seq != gz->seq);
+}
+
+uint16_t GZ_Ratio(const uint32_t energy[GZ_BINS], uint8_t bin, uint8_t ref) {
+	uint32_t e_ref = energy[ref];
+	uint64_t r = ((uint64_t)energy[bin] << 8) / (e_ref ? e_ref : 1);
+	return (r > 0xFFFF) ? 0xFFFF : (uint16_t)r;
+}
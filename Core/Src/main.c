@@ -46,6 +46,8 @@ TIM_HandleTypeDef htim1;
 TIM_HandleTypeDef htim3;
 
 /* USER CODE BEGIN PV */
+DMA_HandleTypeDef hdma_adc;
+TIM_HandleTypeDef htim14;
 
 /* USER CODE END PV */
 
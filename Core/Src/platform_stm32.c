@@ -0,0 +1,28 @@
+#include "platform.h"
+
+extern TIM_HandleTypeDef htim1;
+
+uint32_t PLAT_GetTick(void) {
+	return HAL_GetTick();
+}
+
+void PLAT_SetOutput(PLAT_Output_t out, bool active) {
+	switch (out) {
+		case PLAT_OUT_CTRL_UP:
+			HAL_GPIO_WritePin(CTRL_UP_GPIO_Port, CTRL_UP_Pin, active ? GPIO_PIN_RESET : GPIO_PIN_SET);
+			break;
+		case PLAT_OUT_CTRL_DWN:
+			HAL_GPIO_WritePin(CTRL_DWN_GPIO_Port, CTRL_DWN_Pin, active ? GPIO_PIN_RESET : GPIO_PIN_SET);
+			break;
+		case PLAT_OUT_LED:
+			// LED on TIM1_CH2 PWM
+			if (active) HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_2);
+			else HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_2);
+			break;
+		case PLAT_OUT_BUZZER:
+			// Buzzer on the complementary TIM1_CH1N output
+			if (active) HAL_TIMEx_PWMN_Start(&htim1, TIM_CHANNEL_1);
+			else HAL_TIMEx_PWMN_Stop(&htim1, TIM_CHANNEL_1);
+			break;
+	}
+}
@@ -0,0 +1,96 @@
+#include "pulse_gen.h"
+#include "events.h"
+
+static TIM_HandleTypeDef *_pg_htim;
+static GPIO_TypeDef *_pg_port;
+static uint16_t _pg_pin;
+static uint8_t _pg_single;
+static volatile uint32_t _pg_steps;
+
+void PG_Init(TIM_HandleTypeDef *htim) {
+	__HAL_RCC_TIM14_CLK_ENABLE();
+	htim->Instance = TIM14;
+	htim->Init.Prescaler = SystemCoreClock / PG_TICK_HZ - 1;
+	htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim->Init.Period = 0xFFFF;
+	htim->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	HAL_TIM_Base_Init(htim);
+
+	HAL_NVIC_SetPriority(TIM14_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(TIM14_IRQn);
+
+	_pg_htim = htim;
+}
+
+/**
+ * @brief Pulls the line low and runs the timer from zero.
+ */
+static void pg_run(PLAT_Output_t out, uint32_t period, uint32_t width, uint8_t single) {
+	TIM_TypeDef *tim = _pg_htim->Instance;
+	GPIO_TypeDef *port = (out == PLAT_OUT_CTRL_UP) ? CTRL_UP_GPIO_Port : CTRL_DWN_GPIO_Port;
+	uint16_t pin = (out == PLAT_OUT_CTRL_UP) ? CTRL_UP_Pin : CTRL_DWN_Pin;
+
+	PG_Stop();
+	_pg_port = port;
+	_pg_pin = pin;
+	_pg_single = single;
+	_pg_steps = 0;
+
+	tim->ARR = period - 1;
+	tim->CCR1 = width;
+	tim->CNT = 0;
+	tim->SR = 0;
+	tim->DIER = single ? TIM_DIER_CC1IE : (TIM_DIER_CC1IE | TIM_DIER_UIE);
+
+	port->BRR = pin;
+	tim->CR1 |= TIM_CR1_CEN;
+}
+
+void PG_Start(PLAT_Output_t out, uint16_t period_ms, uint16_t width_ms) {
+	pg_run(out, (uint32_t) period_ms * (PG_TICK_HZ / 1000), (uint32_t) width_ms * (PG_TICK_HZ / 1000), 0);
+}
+
+void PG_Step(PLAT_Output_t out, uint16_t width_ms) {
+	uint32_t width = (uint32_t) width_ms * (PG_TICK_HZ / 1000);
+	pg_run(out, width + 1, width, 1);
+}
+
+void PG_Stop(void) {
+	TIM_TypeDef *tim = _pg_htim->Instance;
+
+	PLAT_CRITICAL_ENTER();
+	tim->CR1 &= ~TIM_CR1_CEN;
+	tim->DIER = 0;
+	tim->SR = 0;
+	if (_pg_port != NULL) _pg_port->BSRR = _pg_pin;
+	_pg_port = NULL;
+	PLAT_CRITICAL_EXIT();
+	NVIC_ClearPendingIRQ(TIM14_IRQn);
+}
+
+uint32_t PG_Steps(void) {
+	return _pg_steps;
+}
+
+void PG_IRQHandler(void) {
+	TIM_TypeDef *tim = _pg_htim->Instance;
+	uint32_t sr = tim->SR & tim->DIER;
+
+	if (sr & TIM_SR_CC1IF) {
+		tim->SR = ~TIM_SR_CC1IF;
+		_pg_port->BSRR = _pg_pin;
+		_pg_steps++;
+		EV_Post(EV_STEP);
+		if (_pg_single) {
+			tim->CR1 &= ~TIM_CR1_CEN;
+			tim->DIER = 0;
+			_pg_port = NULL;
+			return;
+		}
+	}
+	if (sr & TIM_SR_UIF) {
+		tim->SR = ~TIM_SR_UIF;
+		_pg_port->BRR = _pg_pin;
+	}
+}
@@ -0,0 +1,22 @@
+#include "sample_queue.h"
+
+void SQ_Init(SampleQueue_t *q) {
+	q->head = 0;
+	q->tail = 0;
+	q->dropped = 0;
+}
+
+uint8_t SQ_Drain(SampleQueue_t *q, FreqSample_t *out, uint8_t max) {
+	uint8_t tail = q->tail;
+	uint8_t count = q->head - tail;
+	SQ_BARRIER(); // Read slots only after observing head
+
+	if (count > max) count = max;
+	for (uint8_t i = 0; i < count; i++) {
+		out[i] = q->data[(uint8_t)(tail + i) & SQ_MASK];
+	}
+
+	SQ_BARRIER(); // Release slots only after they have been read
+	q->tail = tail + count;
+	return count;
+}
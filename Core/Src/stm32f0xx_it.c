@@ -22,6 +22,10 @@
 #include "stm32f0xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "timebase.h"
+#include "events.h"
+#include "buttons.h"
+#include "pulse_gen.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -57,6 +61,7 @@
 /* External variables --------------------------------------------------------*/
 extern ADC_HandleTypeDef hadc;
 /* USER CODE BEGIN EV */
+extern DMA_HandleTypeDef hdma_adc;
 
 /* USER CODE END EV */
 
@@ -129,6 +134,8 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
+  BTN_Tick();
+  EV_Post(EV_TICK);
 
   /* USER CODE END SysTick_IRQn 1 */
 }
@@ -156,4 +163,44 @@ void ADC1_IRQHandler(void)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles DMA1 channel 1 interrupt (ADC circular buffer).
+  */
+void DMA1_Channel1_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_adc);
+}
+
+/**
+  * @brief This function handles TIM3 global interrupt (timebase overflow).
+  */
+void TIM3_IRQHandler(void)
+{
+  TB_IRQHandler();
+}
+
+/**
+  * @brief This function handles EXTI lines 0 and 1 interrupt (BTN_P).
+  */
+void EXTI0_1_IRQHandler(void)
+{
+  HAL_GPIO_EXTI_IRQHandler(BTN_P_Pin);
+}
+
+/**
+  * @brief This function handles EXTI lines 2 and 3 interrupt (BTN_M).
+  */
+void EXTI2_3_IRQHandler(void)
+{
+  HAL_GPIO_EXTI_IRQHandler(BTN_M_Pin);
+}
+
+/**
+  * @brief This function handles TIM14 global interrupt (channel step pulses).
+  */
+void TIM14_IRQHandler(void)
+{
+  PG_IRQHandler();
+}
+
 /* USER CODE END 1 */
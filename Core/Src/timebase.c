@@ -0,0 +1,55 @@
+#include "timebase.h"
+
+static TIM_HandleTypeDef *_tb_htim;
+static volatile uint32_t _tb_overflows;
+
+void TB_Init(TIM_HandleTypeDef *htim) {
+	htim->Init.Prescaler = 0;
+	htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim->Init.Period = 0xFFFF;
+	htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	HAL_TIM_Base_Init(htim);
+
+	HAL_NVIC_SetPriority(TIM3_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(TIM3_IRQn);
+
+	_tb_htim = htim;
+}
+
+void TB_Start(void) {
+	_tb_overflows = 0;
+	__HAL_TIM_SET_COUNTER(_tb_htim, 0);
+	__HAL_TIM_CLEAR_FLAG(_tb_htim, TIM_FLAG_UPDATE); // Set by the UG event in HAL_TIM_Base_Init
+	HAL_TIM_Base_Start_IT(_tb_htim);
+}
+
+void TB_Stop(void) {
+	HAL_TIM_Base_Stop_IT(_tb_htim);
+}
+
+uint32_t TB_GetRate(void) {
+	return SystemCoreClock / (_tb_htim->Init.Prescaler + 1);
+}
+
+uint32_t TB_Now(void) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t hi = _tb_overflows;
+	uint32_t cnt = _tb_htim->Instance->CNT;
+	// Overflow happened but its interrupt has not run yet (masked or lower priority).
+	// A large cnt means the counter was read before the wrap.
+	if ((_tb_htim->Instance->SR & TIM_SR_UIF) && cnt < 0x8000) {
+		hi++;
+	}
+
+	__set_PRIMASK(primask);
+	return (hi << 16) | cnt;
+}
+
+void TB_IRQHandler(void) {
+	if (_tb_htim->Instance->SR & TIM_SR_UIF) {
+		_tb_htim->Instance->SR = ~TIM_SR_UIF;
+		_tb_overflows++;
+	}
+}
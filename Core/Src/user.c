@@ -1,30 +1,54 @@
 #include "user.h"
 #include "adc_pulse_freq.h"
-#include "CircularBuffer.h"
 #include "fsm.h"
+#include "events.h"
+#include "buttons.h"
+#include "pulse_gen.h"
 extern TIM_HandleTypeDef htim3;
 extern ADC_HandleTypeDef hadc;
+extern DMA_HandleTypeDef hdma_adc;
+extern TIM_HandleTypeDef htim14;
 FrequencyMeter_t freq;
-CircularBuffer cb;
+SampleQueue_t freq_queue;
+VideoStd_t freq_video;
+EV_Stats_t user_load; ///< Main loop load over the last second, for the debugger
 
 void USER_Init() {
-	cb.size=70;
-	cb.item_size = sizeof(uint8_t);
-	CB_Init(&cb);
+	SQ_Init(&freq_queue);
+	VS_Reset(&freq_video);
 
 	freq.hadc=&hadc;
 	freq.adcChannel = ADC_CHANNEL_0;
 	freq.htim=&htim3;
+	freq.hdma=&hdma_adc;
+	freq.mode = FREQ_MODE_DMA;
 	freq.threshold_high = 150;
 	freq.threshold_low = 100;
-	freq.frequency = &cb;
-	freq._timeout = 1e3;
+	freq.adaptive = 1; // Thresholds above are only the starting point
+	freq.env_high_q8 = FREQ_ENV_HIGH_Q8;
+	freq.env_low_q8 = FREQ_ENV_LOW_Q8;
+	freq.sample_rate = 800000;
+	freq.goertzel = 0; // Tone detector is diagnostic only, the FSM decides on edge periods
+	freq.sync_width_min = FREQ_US_TO_TICKS(3);
+	freq.sync_width_max = FREQ_US_TO_TICKS(7);
+	freq.frequency = &freq_queue;
+	freq.video = &freq_video;
 	FREQ_Init(&freq);
 	FREQ_Start(&freq);
+	BTN_Init();
+	PG_Init(&htim14);
 	FSM_Init();
 }
 
 void USER_Loop() {
+	static uint32_t stats_tick;
+
+	EV_Wait();
 	FSM_Process();
+
+	if (HAL_GetTick() - stats_tick >= 1000) {
+		stats_tick = HAL_GetTick();
+		EV_TakeStats(&user_load);
+	}
 }
 
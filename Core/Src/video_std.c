@@ -0,0 +1,81 @@
+#include "video_std.h"
+
+/**
+ * @brief Classifies the field that ended at a boundary and updates the confidence.
+ */
+static void vs_field_end(VideoStd_t *vs) {
+	uint32_t t = vs->field_ticks;
+	uint16_t lines = vs->lines;
+	VS_Standard_t std = VS_UNKNOWN;
+
+	if (vs->bad <= VS_MAX_BAD) {
+		if (t >= VS_PAL_FIELD - VS_FIELD_TOL && t <= VS_PAL_FIELD + VS_FIELD_TOL &&
+			lines >= VS_PAL_LINES - VS_LINES_TOL && lines <= VS_PAL_LINES + VS_LINES_TOL) {
+			std = VS_PAL;
+		} else if (t >= VS_NTSC_FIELD - VS_FIELD_TOL && t <= VS_NTSC_FIELD + VS_FIELD_TOL &&
+			lines >= VS_NTSC_LINES - VS_LINES_TOL && lines <= VS_NTSC_LINES + VS_LINES_TOL) {
+			std = VS_NTSC;
+		}
+	}
+
+	if (std == VS_UNKNOWN) {
+		if (vs->confidence > 0) vs->confidence--;
+	} else if (std == vs->standard) {
+		if (vs->confidence < VS_CONF_MAX) vs->confidence++;
+	} else {
+		vs->standard = std;
+		vs->confidence = 1;
+	}
+}
+
+void VS_Reset(VideoStd_t *vs) {
+	vs->field_ticks = 0;
+	vs->lines = 0;
+	vs->halves = 0;
+	vs->bad = 0;
+	vs->in_vbi = 0;
+	vs->locked = 0;
+	vs->standard = VS_UNKNOWN;
+	vs->confidence = 0;
+}
+
+void VS_Edge(VideoStd_t *vs, uint32_t period) {
+	vs->field_ticks += period;
+
+	if (period >= VS_HALF_MIN && period <= VS_HALF_MAX) {
+		if (!vs->in_vbi && ++vs->halves == VS_MIN_HALVES) {
+			// Field boundary: close the field that started at the previous one
+			if (vs->locked) vs_field_end(vs);
+			vs->locked = 1;
+			vs->in_vbi = 1;
+			vs->field_ticks = 0;
+			vs->lines = 0;
+			vs->bad = 0;
+		}
+		return;
+	}
+
+	if (vs->in_vbi && period < VS_LINE_MIN) {
+		// Trailing edges shift by the broad pulse width where the broad
+		// pulses start and end; that is still the same vertical interval
+		return;
+	}
+
+	vs->in_vbi = 0;
+	vs->halves = 0;
+	if (period >= VS_LINE_MIN && period <= VS_LINE_MAX) {
+		vs->lines++;
+	} else if (vs->bad < 0xFF) {
+		vs->bad++;
+	}
+
+	if (vs->field_ticks > VS_FIELD_TIMEOUT) {
+		// No vertical interval where one was due: not a video field structure
+		vs->locked = 0;
+		vs->field_ticks = 0;
+		vs->lines = 0;
+		vs->bad = 0;
+		vs->standard = VS_UNKNOWN;
+		vs->confidence = 0;
+	}
+}
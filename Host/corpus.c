@@ -0,0 +1,105 @@
+/**
+ * @file corpus.c
+ * @brief Trace corpus loading and the built-in synthetic corpus.
+ */
+
+#include "corpus.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const double _corpus_snr_db[] = { -3, 0, 3, 6, 9, 12, 15, 20, 30 };
+#define CORPUS_SNRS     (sizeof(_corpus_snr_db) / sizeof(_corpus_snr_db[0]))
+#define CORPUS_NOISE_KINDS  5
+
+size_t CORPUS_SyntheticCount(int reps, double noise_min) {
+	return CORPUS_SNRS * 2 * reps + (size_t) ceil(noise_min * 60 / CORPUS_NOISE_S);
+}
+
+size_t CORPUS_AddSynthetic(CorpusItem_t *items, size_t n, int reps, double video_s, double noise_min, uint64_t seed) {
+	for (size_t s = 0; s < CORPUS_SNRS; s++) {
+		for (int std = 0; std < 2; std++) {
+			for (int k = 0; k < reps; k++) {
+				CorpusItem_t *it = &items[n++];
+				memset(it, 0, sizeof(*it));
+				SYN_Defaults(&it->syn);
+				it->syn.video = std ? SYN_VIDEO_NTSC : SYN_VIDEO_PAL;
+				it->syn.seed = seed++;
+				SYN_SetSnr(&it->syn, _corpus_snr_db[s]);
+				it->seconds = video_s;
+			}
+		}
+	}
+
+	int traces = (int) ceil(noise_min * 60 / CORPUS_NOISE_S);
+	for (int k = 0; k < traces; k++) {
+		CorpusItem_t *it = &items[n++];
+		memset(it, 0, sizeof(*it));
+		SYN_Defaults(&it->syn);
+		it->syn.video = SYN_VIDEO_NONE;
+		it->syn.seed = seed++;
+		it->syn.noise_rms = 3;
+		it->seconds = CORPUS_NOISE_S;
+		switch (k % CORPUS_NOISE_KINDS) {
+			case 0:
+				it->syn.noise_rms = 8;
+				break;
+			case 1:
+				it->syn.noise_rms = 25;
+				break;
+			case 2:
+				it->syn.interferer = SYN_INT_TONE;
+				it->syn.int_hz = 15625;
+				it->syn.int_amplitude = 60;
+				break;
+			case 3:
+				// Sync-shaped pulses at the NTSC line rate, no field structure
+				it->syn.interferer = SYN_INT_PULSE;
+				it->syn.int_hz = 15734;
+				it->syn.int_width_us = 5;
+				it->syn.int_amplitude = -30;
+				break;
+			default:
+				it->syn.interferer = SYN_INT_FM;
+				it->syn.int_hz = 15700;
+				it->syn.int_span_hz = 600;
+				it->syn.int_amplitude = 60;
+				break;
+		}
+	}
+	return n;
+}
+
+int CORPUS_Load(const CorpusItem_t *item, Trace_t *trace) {
+	if (item->path != NULL) {
+		return TRACE_Open(trace, item->path);
+	}
+
+	SYN_Generator_t gen;
+	memset(trace, 0, sizeof(*trace));
+	size_t count = (size_t) (item->seconds * item->syn.sample_rate);
+	uint8_t *samples = malloc(count);
+	if (samples == NULL || SYN_Init(&gen, &item->syn) != 0) {
+		fprintf(stderr, "out of memory generating a trace\n");
+		free(samples);
+		return -1;
+	}
+	SYN_Generate(&gen, samples, count);
+	SYN_Free(&gen);
+
+	trace->samples = samples;
+	trace->count = count;
+	trace->header.sample_rate = item->syn.sample_rate;
+	trace->header.label = SYN_Label(&item->syn);
+	trace->header.snr_db = SYN_SnrDb(&item->syn);
+	return 0;
+}
+
+void CORPUS_Unload(const CorpusItem_t *item, Trace_t *trace) {
+	if (item->path != NULL) {
+		TRACE_Close(trace);
+	} else {
+		free((void *) trace->samples);
+		memset(trace, 0, sizeof(*trace));
+	}
+}
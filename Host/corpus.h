@@ -0,0 +1,55 @@
+/**
+ * @file corpus.h
+ * @brief Labelled trace corpora for the benchmark and the parameter sweep.
+ *
+ * An entry is either a trace file or a generator setting; generated traces
+ * are produced in memory when loaded, so the built-in corpus needs no disk.
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include "synth.h"
+#include "trace.h"
+
+#define CORPUS_NOISE_S      30      ///< Length of each built-in noise or interferer trace
+
+/**
+ * @brief One corpus entry.
+ */
+typedef struct {
+    const char *path;           /**< Trace file, NULL for generated */
+    SYN_Config_t syn;           /**< Generator setting when path is NULL */
+    double seconds;             /**< Generated length */
+} CorpusItem_t;
+
+/**
+ * @brief Entries CORPUS_AddSynthetic() appends for the given settings.
+ */
+size_t CORPUS_SyntheticCount(int reps, double noise_min);
+
+/**
+ * @brief Appends the built-in synthetic corpus.
+ *
+ * Video: PAL and NTSC at sync-depth SNRs from -3 to 30 dB, reps seeds each,
+ * video_s long. Noise: CORPUS_NOISE_S traces cycling through white noise and
+ * interferers near the line rate, among them a pulse train with the sync
+ * shape, until noise_min minutes are filled.
+ *
+ * @return New number of entries.
+ */
+size_t CORPUS_AddSynthetic(CorpusItem_t *items, size_t n, int reps, double video_s, double noise_min, uint64_t seed);
+
+/**
+ * @brief Maps or generates the trace of an entry.
+ *
+ * @return 0 on success, -1 with a message on stderr otherwise.
+ */
+int CORPUS_Load(const CorpusItem_t *item, Trace_t *trace);
+
+/**
+ * @brief Releases a trace loaded with CORPUS_Load().
+ */
+void CORPUS_Unload(const CorpusItem_t *item, Trace_t *trace);
+
+#endif // CORPUS_H
@@ -0,0 +1,70 @@
+/**
+ * @file parallel.c
+ * @brief fork() based process pool.
+ */
+
+#include "parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int PAR_Cpus(void) {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? (int) n : 1;
+}
+
+int PAR_Map(int jobs, size_t count, PAR_Fn_t fn, void *ctx, void *results, size_t result_size) {
+	if (jobs <= 0) jobs = PAR_Cpus();
+	if ((size_t) jobs > count) jobs = (int) count;
+
+	memset(results, 0, count * result_size);
+	if (jobs <= 1) {
+		for (size_t i = 0; i < count; i++) {
+			fn(i, (char *) results + i * result_size, ctx);
+		}
+		return 0;
+	}
+
+	size_t len = count * result_size;
+	char *shared = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (shared == MAP_FAILED) {
+		perror("mmap");
+		return -1;
+	}
+
+	// Nothing buffered may be flushed twice by the children
+	fflush(NULL);
+
+	int status = 0;
+	int started = 0;
+	for (int w = 0; w < jobs; w++) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			for (size_t i = w; i < count; i += jobs) {
+				fn(i, shared + i * result_size, ctx);
+			}
+			fflush(NULL);
+			_exit(0);
+		}
+		if (pid < 0) {
+			perror("fork");
+			status = -1;
+			break;
+		}
+		started++;
+	}
+
+	while (started-- > 0) {
+		int ws;
+		if (wait(&ws) < 0 || !WIFEXITED(ws) || WEXITSTATUS(ws) != 0) {
+			status = -1;
+		}
+	}
+
+	memcpy(results, shared, len);
+	munmap(shared, len);
+	return status;
+}
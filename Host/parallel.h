@@ -0,0 +1,39 @@
+/**
+ * @file parallel.h
+ * @brief Process pool for the host tools.
+ *
+ * The firmware logic keeps its state in globals, so runs are isolated in
+ * forked worker processes rather than threads. Each worker takes every
+ * jobs-th item and stores its result in a shared mapping; the caller gets
+ * the results back in item order.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+/**
+ * @brief Computes the result of one item, in a worker process.
+ *
+ * @param index Item number, 0..count-1.
+ * @param result Zeroed result slot of result_size bytes.
+ * @param ctx Caller context, a copy of the parent's at fork time.
+ */
+typedef void (*PAR_Fn_t)(size_t index, void *result, void *ctx);
+
+/**
+ * @brief Number of online CPUs, at least 1.
+ */
+int PAR_Cpus(void);
+
+/**
+ * @brief Runs fn over count items on up to jobs worker processes.
+ *
+ * @param jobs Worker count, 0 for PAR_Cpus(). 1 runs in the calling process.
+ * @param results Receives count results of result_size bytes each.
+ * @return 0 on success, -1 if a worker could not be started or failed.
+ */
+int PAR_Map(int jobs, size_t count, PAR_Fn_t fn, void *ctx, void *results, size_t result_size);
+
+#endif // PARALLEL_H
@@ -0,0 +1,211 @@
+/**
+ * @file platform_host.c
+ * @brief Virtual-clock implementation of the platform interface and hardware modules.
+ */
+
+#include "platform.h"
+#include "adc_pulse_freq.h"
+#include "pulse_gen.h"
+#include "buttons.h"
+#include "events.h"
+
+#define HOST_US_PER_MS  1000U
+#define HOST_MIN_RELEASE_US  20000U  ///< Shortest release between pulses the receiver counts as two presses
+
+volatile uint32_t ev_pending;
+
+static uint64_t _host_now;
+static bool _host_out[PLAT_OUT_BUZZER + 1];
+static int32_t _host_position;
+static uint64_t _host_out_released[PLAT_OUT_BUZZER + 1];  ///< Last release of each output, us
+static uint32_t _host_short_releases;
+
+static uint8_t _host_buttons;
+static uint8_t _host_pressed;
+static uint8_t _host_released;
+
+/**
+ * @brief Pulse generator model, same timing as the TIM14 one.
+ */
+static struct {
+	bool running;
+	bool single;
+	PLAT_Output_t out;
+	uint64_t start;             /**< Start of the current pulse */
+	uint32_t period;            /**< us */
+	uint32_t width;             /**< us */
+	uint32_t steps;
+	bool merged;                /**< Current pulse follows the last one too closely to count */
+} _host_pg;
+
+void HOST_Reset(void) {
+	_host_now = 0;
+	for (int i = 0; i <= PLAT_OUT_BUZZER; i++) {
+		_host_out[i] = false;
+		_host_out_released[i] = 0;
+	}
+	_host_position = 0;
+	_host_short_releases = 0;
+	_host_buttons = 0;
+	_host_pressed = 0;
+	_host_released = 0;
+	_host_pg.running = false;
+	_host_pg.steps = 0;
+	ev_pending = 0;
+}
+
+/**
+ * @brief Asserts the generator's line, noting a pulse that starts too soon after the previous release.
+ */
+static void host_pg_press(void) {
+	PLAT_Output_t out = _host_pg.out;
+	_host_pg.merged = _host_out_released[out] != 0 && _host_now < _host_out_released[out] + HOST_MIN_RELEASE_US;
+	if (_host_pg.merged) _host_short_releases++;
+	_host_out[out] = true;
+}
+
+/**
+ * @brief Releases the generator's line.
+ */
+static void host_pg_release(void) {
+	_host_out[_host_pg.out] = false;
+	_host_out_released[_host_pg.out] = _host_now;
+}
+
+void HOST_Advance(uint32_t us) {
+	uint64_t target = _host_now + us;
+
+	while (_host_pg.running) {
+		uint64_t end = _host_pg.start + _host_pg.width;
+		if (_host_out[_host_pg.out]) {
+			// Pulse in progress, ends on the compare event
+			if (end > target) break;
+			_host_now = end;
+			host_pg_release();
+			_host_pg.steps++;
+			// A merged pulse only lengthened the previous press
+			if (!_host_pg.merged) _host_position += (_host_pg.out == PLAT_OUT_CTRL_UP) ? 1 : -1;
+			EV_Post(EV_STEP);
+			if (_host_pg.single) _host_pg.running = false;
+		} else {
+			// Between pulses, the next one starts on the update event
+			uint64_t next = _host_pg.start + _host_pg.period;
+			if (next > target) break;
+			_host_now = next;
+			_host_pg.start = next;
+			host_pg_press();
+		}
+	}
+
+	if ((_host_now / HOST_US_PER_MS) != (target / HOST_US_PER_MS)) {
+		EV_Post(EV_TICK);
+	}
+	_host_now = target;
+}
+
+uint64_t HOST_NowUs(void) {
+	return _host_now;
+}
+
+bool HOST_GetOutput(int out) {
+	return _host_out[out];
+}
+
+int32_t HOST_GetPosition(void) {
+	return _host_position;
+}
+
+uint32_t HOST_GetShortReleases(void) {
+	return _host_short_releases;
+}
+
+void HOST_SetButtons(uint8_t mask) {
+	_host_pressed |= mask & ~_host_buttons;
+	_host_released |= _host_buttons & ~mask;
+	if (mask != _host_buttons) EV_Post(EV_BUTTON);
+	_host_buttons = mask;
+}
+
+uint32_t PLAT_GetTick(void) {
+	return (uint32_t) (_host_now / HOST_US_PER_MS);
+}
+
+void PLAT_SetOutput(PLAT_Output_t out, bool active) {
+	_host_out[out] = active;
+}
+
+/* Pulse generator ----------------------------------------------------------*/
+
+void PG_Init(TIM_HandleTypeDef *htim) {
+	_host_pg.running = false;
+}
+
+static void host_pg_run(PLAT_Output_t out, uint32_t period, uint32_t width, bool single) {
+	PG_Stop();
+	_host_pg.out = out;
+	_host_pg.period = period;
+	_host_pg.width = width;
+	_host_pg.single = single;
+	_host_pg.start = _host_now;
+	_host_pg.steps = 0;
+	_host_pg.running = true;
+	host_pg_press();
+}
+
+void PG_Start(PLAT_Output_t out, uint16_t period_ms, uint16_t width_ms) {
+	host_pg_run(out, period_ms * HOST_US_PER_MS, width_ms * HOST_US_PER_MS, false);
+}
+
+void PG_Step(PLAT_Output_t out, uint16_t width_ms) {
+	host_pg_run(out, width_ms * HOST_US_PER_MS, width_ms * HOST_US_PER_MS, true);
+}
+
+void PG_Stop(void) {
+	if (_host_pg.running && _host_out[_host_pg.out]) host_pg_release();
+	_host_pg.running = false;
+}
+
+uint32_t PG_Steps(void) {
+	return _host_pg.steps;
+}
+
+void PG_IRQHandler(void) {
+}
+
+/* Buttons ------------------------------------------------------------------*/
+
+void BTN_Init(void) {
+}
+
+void BTN_Tick(void) {
+}
+
+uint8_t BTN_State(void) {
+	return _host_buttons;
+}
+
+uint8_t BTN_TakePressed(void) {
+	uint8_t pressed = _host_pressed;
+	_host_pressed = 0;
+	return pressed;
+}
+
+uint8_t BTN_TakeReleased(void) {
+	uint8_t released = _host_released;
+	_host_released = 0;
+	return released;
+}
+
+/* Frequency meter acquisition ----------------------------------------------*/
+
+void FREQ_Init(FrequencyMeter_t *freq_meter) {
+	// Samples come from FREQ_ProcessBlock() at the trace rate
+	FREQ_Configure(freq_meter, freq_meter->sample_rate);
+}
+
+void FREQ_Start(FrequencyMeter_t *freq_meter) {
+	FREQ_Reset(freq_meter);
+}
+
+void FREQ_Stop(FrequencyMeter_t *freq_meter) {
+}
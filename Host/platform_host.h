@@ -0,0 +1,65 @@
+/**
+ * @file platform_host.h
+ * @brief Linux host backend of the platform interface.
+ *
+ * Stands in for main.h when PLATFORM_HOST is defined. HAL handle types only
+ * exist as incomplete structs, so shared headers still compile; the
+ * portable logic never dereferences them. Time is virtual: it moves only
+ * when the simulation calls HOST_Advance(), and the pulse generator,
+ * outputs and buttons are modelled against that clock.
+ */
+
+#ifndef PLATFORM_HOST_H
+#define PLATFORM_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct ADC_HandleTypeDef ADC_HandleTypeDef;
+typedef struct TIM_HandleTypeDef TIM_HandleTypeDef;
+typedef struct DMA_HandleTypeDef DMA_HandleTypeDef;
+
+/// The simulation is single threaded; "interrupts" run inline from HOST_Advance()
+#define PLAT_CRITICAL_ENTER() do { } while (0)
+#define PLAT_CRITICAL_EXIT()  do { } while (0)
+
+/**
+ * @brief Restores power-on state: time 0, outputs released, generator stopped.
+ */
+void HOST_Reset(void);
+
+/**
+ * @brief Moves the virtual clock forward, running pulse generator events on the way.
+ */
+void HOST_Advance(uint32_t us);
+
+/**
+ * @brief Virtual time in microseconds.
+ */
+uint64_t HOST_NowUs(void);
+
+/**
+ * @brief Current level of an output, true while asserted.
+ */
+bool HOST_GetOutput(int out);
+
+/**
+ * @brief Completed up steps minus completed down steps since HOST_Reset().
+ */
+int32_t HOST_GetPosition(void);
+
+/**
+ * @brief Pulses since HOST_Reset() that started too soon after the previous release on their line.
+ *
+ * The receiver reads such a pulse as part of the previous press, so it does
+ * not move HOST_GetPosition().
+ */
+uint32_t HOST_GetShortReleases(void);
+
+/**
+ * @brief Sets the held buttons (BTN_MASK_*), producing press and release edges.
+ */
+void HOST_SetButtons(uint8_t mask);
+
+#endif // PLATFORM_HOST_H
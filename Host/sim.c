@@ -0,0 +1,137 @@
+/**
+ * @file sim.c
+ * @brief Trace replay on the virtual clock.
+ */
+
+#include "sim.h"
+#include "buttons.h"
+#include <string.h>
+#include <time.h>
+
+FrequencyMeter_t freq;
+static SampleQueue_t _sim_queue;
+static VideoStd_t _sim_video;
+
+void SIM_Defaults(SIM_Config_t *config) {
+	memset(config, 0, sizeof(*config));
+	config->threshold_high = 150;
+	config->threshold_low = 100;
+	config->adaptive = 1;
+	config->env_high_q8 = FREQ_ENV_HIGH_Q8;
+	config->env_low_q8 = FREQ_ENV_LOW_Q8;
+	config->sync_match = 1;
+	config->window_ms = 100;
+	FSM_DefaultDetection(&config->detection);
+}
+
+/**
+ * @brief Brings meter, queue, field tracker and FSM to the state USER_Init() leaves them in.
+ */
+static void sim_init(const SIM_Config_t *config, uint32_t sample_rate) {
+	HOST_Reset();
+	SQ_Init(&_sim_queue);
+	VS_Reset(&_sim_video);
+
+	memset(&freq, 0, sizeof(freq));
+	freq.mode = FREQ_MODE_DMA;
+	freq.threshold_high = config->threshold_high;
+	freq.threshold_low = config->threshold_low;
+	freq.adaptive = config->adaptive;
+	freq.env_high_q8 = config->env_high_q8;
+	freq.env_low_q8 = config->env_low_q8;
+	freq.sample_rate = sample_rate;
+	if (config->sync_match) {
+		freq.sync_width_min = FREQ_US_TO_TICKS(3);
+		freq.sync_width_max = FREQ_US_TO_TICKS(7);
+	}
+	freq.frequency = &_sim_queue;
+	freq.video = &_sim_video;
+	FREQ_Init(&freq);
+	FREQ_Start(&freq);
+	FSM_SetDetection(&config->detection);
+	FSM_Init();
+}
+
+static double sim_wall_time(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void SIM_Run(const SIM_Config_t *config, const Trace_t *trace, SIM_Result_t *result) {
+	const uint32_t rate = trace->header.sample_rate;
+	double wall = sim_wall_time();
+
+	memset(result, 0, sizeof(*result));
+	result->first_alarm_us = -1;
+	sim_init(config, rate);
+
+	uint64_t press_us = SIM_PRESS_AT_MS * 1000ULL;
+	uint64_t release_us = 0;
+	uint64_t search_us = 0;
+	uint64_t window_end_us = config->window_ms * 1000ULL;
+	uint32_t window_index = 0;
+	uint64_t frac = 0;  // Leftover of the block duration, 1/rate us
+	bool alarm = false;
+
+	for (size_t pos = 0; pos < trace->count; pos += SIM_BLOCK_LEN) {
+		uint32_t len = (trace->count - pos < SIM_BLOCK_LEN) ? trace->count - pos : SIM_BLOCK_LEN;
+
+		FREQ_ProcessBlock(&freq, trace->samples + pos, len);
+		frac += (uint64_t) len * 1000000U;
+		HOST_Advance(frac / rate);
+		frac %= rate;
+
+		uint64_t now = HOST_NowUs();
+		if (press_us != 0 && now >= press_us) {
+			HOST_SetButtons(BTN_MASK_P);
+			press_us = 0;
+			release_us = now + SIM_PRESS_MS * 1000U;
+		} else if (release_us != 0 && now >= release_us) {
+			HOST_SetButtons(0);
+			release_us = 0;
+			search_us = now;
+		}
+
+		FSM_Process();
+
+		if (FSM_InAlarm() != alarm) {
+			alarm = !alarm;
+			if (alarm) {
+				if (result->alarms++ == 0) {
+					result->first_alarm_us = now - search_us;
+					result->standard = FSM_GetStandard();
+					result->channel = FSM_GetChannel();
+				}
+				if (config->resume) press_us = now;
+			}
+		}
+
+		if (window_end_us != 0 && now >= window_end_us) {
+			SIM_Window_t w = {
+				.index = window_index++,
+				.end_ms = now / 1000U,
+				.threshold_high = freq.threshold_high,
+				.threshold_low = freq.threshold_low,
+				.channel = FSM_GetChannel(),
+				.alarm = alarm,
+				.standard = _sim_video.standard,
+				.confidence = _sim_video.confidence,
+			};
+			FREQ_TakeSyncStats(&freq, &w.sync);
+			result->pulses += w.sync.pulses;
+			result->matched += w.sync.matched;
+			if (config->on_window != NULL) config->on_window(&w, config->ctx);
+			window_end_us += config->window_ms * 1000ULL;
+		}
+	}
+
+	FREQ_SyncStats_t rest;
+	FREQ_TakeSyncStats(&freq, &rest);
+	result->pulses += rest.pulses;
+	result->matched += rest.matched;
+	result->duration_us = HOST_NowUs();
+	result->steps = HOST_GetPosition();
+	result->short_releases = HOST_GetShortReleases();
+	result->wall_s = sim_wall_time() - wall;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file sim.h
+ * @brief Replays an ADC trace through the frequency meter and the search FSM.
+ *
+ * The trace is fed in half-DMA-buffer blocks, as FREQ_ProcessBlock() sees
+ * them on target, and the virtual clock advances by each block's duration
+ * before the FSM runs. A scripted press and release of the up button starts
+ * the search; optionally the same press resumes it after every alarm, which
+ * turns long noise traces into false alarm counts. The receiver is not
+ * modelled: the trace plays on whatever channel the search is on.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "adc_pulse_freq.h"
+#include "fsm.h"
+#include "trace.h"
+
+#define SIM_BLOCK_LEN       (FREQ_DMA_BUF_LEN / 2)  ///< Samples per block, one DMA half-buffer
+#define SIM_PRESS_AT_MS     10      ///< Search button press, virtual time
+#define SIM_PRESS_MS        50      ///< Button hold time; the search starts at release
+
+/**
+ * @brief Statistics of one reporting window.
+ */
+typedef struct {
+    uint32_t index;             /**< Window number from the trace start */
+    uint32_t end_ms;            /**< Virtual time at the window end */
+    FREQ_SyncStats_t sync;      /**< Sync matching counters over the window */
+    uint8_t threshold_high;     /**< Comparator band at the window end */
+    uint8_t threshold_low;
+    uint8_t channel;            /**< FSM channel index */
+    uint8_t alarm;              /**< 1 if the FSM was alarming */
+    VS_Standard_t standard;     /**< Field tracker standard, any confidence */
+    uint8_t confidence;         /**< Field tracker confidence */
+} SIM_Window_t;
+
+typedef void (*SIM_WindowFn_t)(const SIM_Window_t *window, void *ctx);
+
+/**
+ * @brief Meter settings and run script.
+ */
+typedef struct {
+    uint8_t threshold_high;     /**< Initial or fixed comparator band */
+    uint8_t threshold_low;
+    uint8_t adaptive;           /**< Envelope-derived thresholds */
+    uint8_t env_high_q8;        /**< Adaptive band position, FrequencyMeter_t::env_high_q8 */
+    uint8_t env_low_q8;
+    uint8_t sync_match;         /**< Sync width matching at 3..7 us */
+    FSM_Detection_t detection;  /**< Channel decision parameters */
+    uint8_t resume;             /**< Press the button again after each alarm */
+    uint32_t window_ms;         /**< Reporting window, 0 for none */
+    SIM_WindowFn_t on_window;   /**< Called at each window end, may be NULL */
+    void *ctx;                  /**< Passed to on_window */
+} SIM_Config_t;
+
+/**
+ * @brief Outcome of one replay.
+ */
+typedef struct {
+    uint64_t duration_us;       /**< Virtual time covered by the trace */
+    uint32_t alarms;            /**< Alarms entered */
+    int64_t first_alarm_us;     /**< First alarm, from the start of the search, -1 if none */
+    VS_Standard_t standard;     /**< Standard confirmed with the first alarm */
+    uint8_t channel;            /**< Channel index of the first alarm */
+    int32_t steps;              /**< Net channel steps at the end */
+    uint32_t short_releases;    /**< Step pulses the receiver would merge with the previous one */
+    uint32_t pulses;            /**< Pulses seen by the meter */
+    uint32_t matched;           /**< Pulses matching the sync shape */
+    double wall_s;              /**< Host time spent */
+} SIM_Result_t;
+
+/**
+ * @brief Settings of the firmware build (user.c).
+ */
+void SIM_Defaults(SIM_Config_t *config);
+
+/**
+ * @brief Replays a whole trace from power-on state.
+ */
+void SIM_Run(const SIM_Config_t *config, const Trace_t *trace, SIM_Result_t *result);
+
+#endif // SIM_H
@@ -0,0 +1,482 @@
+/**
+ * @file svo_bench.c
+ * @brief Detection quality benchmark of the detector variants over a labelled corpus.
+ *
+ * Every trace is replayed once per variant. Video traces give the
+ * probability of detection per SNR, counted as an alarm on the first
+ * channel the search visits (a real search would have stepped past the
+ * transmitter otherwise), and the time from search start to the first
+ * alarm. Noise and interferer traces run with the search resumed after
+ * each alarm and give false alarms per hour.
+ *
+ * The corpus is trace files given on the command line, the built-in
+ * synthetic one (-g), or both. Results go out as CSV; with -c a previous
+ * CSV is the baseline and the exit status is 3 on a regression.
+ */
+
+#include "sim.h"
+#include "corpus.h"
+#include "parallel.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MAX_VARIANTS  8
+#define BENCH_FIRST_CHANNEL 1       ///< Channel index after the first search step
+#define BENCH_PD_TOL        0.05    ///< Allowed drop of pd against the baseline
+
+/**
+ * @brief Detector variant, from the original detector to the current firmware.
+ */
+typedef struct {
+	const char *name;
+	uint8_t adaptive;           /**< Envelope thresholds instead of the fixed band */
+	uint8_t sync_match;         /**< Sync width matching */
+	uint8_t sequential;         /**< Sequential test instead of the window count */
+	uint8_t field;              /**< Field structure check before alarming */
+} Variant_t;
+
+static const Variant_t _variants[] = {
+	{ "window",   0, 0, 0, 0 }, // Fixed hysteresis band and out-of-band count over the window
+	{ "sprt",     0, 0, 1, 0 },
+	{ "adaptive", 1, 0, 1, 0 },
+	{ "sync",     1, 1, 1, 0 },
+	{ "firmware", 1, 1, 1, 1 },
+};
+#define BENCH_VARIANTS  (sizeof(_variants) / sizeof(_variants[0]))
+
+_Static_assert(BENCH_VARIANTS <= BENCH_MAX_VARIANTS, "variant table");
+
+typedef struct {
+	CorpusItem_t *items;
+	const Variant_t *variants[BENCH_MAX_VARIANTS];
+	size_t variant_count;
+	uint8_t threshold_high;     /**< Fixed band of the non-adaptive variants */
+	uint8_t threshold_low;
+} Bench_t;
+
+/**
+ * @brief Outcome of one trace under one variant.
+ */
+typedef struct {
+	uint32_t alarms;
+	int64_t tta_us;             /**< First alarm from search start, -1 if none */
+	uint8_t channel;            /**< Channel of the first alarm */
+	uint8_t standard;           /**< VS_Standard_t confirmed with the first alarm */
+} Outcome_t;
+
+typedef struct {
+	int ok;
+	uint8_t label;              /**< TraceLabel_t */
+	int8_t snr_db;
+	double seconds;
+	Outcome_t v[BENCH_MAX_VARIANTS];
+} ItemResult_t;
+
+static void run_item(size_t index, void *result, void *ctx) {
+	const Bench_t *bench = ctx;
+	const CorpusItem_t *item = &bench->items[index];
+	ItemResult_t *r = result;
+	Trace_t trace;
+
+	if (CORPUS_Load(item, &trace) != 0) return;
+
+	r->ok = 1;
+	r->label = trace.header.label;
+	r->snr_db = trace.header.snr_db;
+	r->seconds = (double) trace.count / trace.header.sample_rate;
+
+	for (size_t v = 0; v < bench->variant_count; v++) {
+		const Variant_t *variant = bench->variants[v];
+		SIM_Config_t config;
+		SIM_Result_t sim;
+
+		SIM_Defaults(&config);
+		config.window_ms = 0;
+		config.resume = (r->label == TRACE_LABEL_NOISE);
+		config.adaptive = variant->adaptive;
+		if (!variant->adaptive) {
+			config.threshold_high = bench->threshold_high;
+			config.threshold_low = bench->threshold_low;
+		}
+		config.sync_match = variant->sync_match;
+		config.detection.sequential = variant->sequential;
+		if (!variant->field) config.detection.field_min_conf = 0;
+
+		SIM_Run(&config, &trace, &sim);
+		r->v[v] = (Outcome_t) { sim.alarms, sim.first_alarm_us, sim.channel, sim.standard };
+	}
+
+	CORPUS_Unload(item, &trace);
+}
+
+static int cmp_double(const void *a, const void *b) {
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Nearest-rank percentile of a sorted list.
+ */
+static double percentile(const double *v, size_t n, double p) {
+	size_t rank = (size_t) ceil(p * n);
+	return v[(rank > 0) ? rank - 1 : 0];
+}
+
+/**
+ * @brief Aggregate of one CSV row.
+ */
+typedef struct {
+	char variant[16];
+	char cls[8];                /**< "video" or "noise" */
+	char snr[8];                /**< dB, "all" or empty */
+	size_t traces;
+	double pd;                  /**< NAN where not applicable */
+	double std_ok;
+	double tta_median_ms;
+	double tta_p99_ms;
+	uint32_t false_alarms;
+	double fa_per_hour;
+	double hours;
+} Row_t;
+
+/**
+ * @brief Video row over the traces with the given SNR, or all video traces for TRACE_SNR_NONE - 1.
+ */
+static int video_row(Row_t *row, const ItemResult_t *res, size_t count, size_t v, const Variant_t *variant, int snr, double *scratch) {
+	size_t n = 0, hits = 0, std_ok = 0, alarmed = 0;
+	const int all = (snr < TRACE_SNR_NONE);
+
+	for (size_t i = 0; i < count; i++) {
+		const ItemResult_t *r = &res[i];
+		if (!r->ok || (r->label != TRACE_LABEL_PAL && r->label != TRACE_LABEL_NTSC)) continue;
+		if (!all && r->snr_db != snr) continue;
+		const Outcome_t *o = &r->v[v];
+		n++;
+		if (o->tta_us < 0) continue;
+		scratch[alarmed++] = o->tta_us / 1e3;
+		if (o->channel != BENCH_FIRST_CHANNEL) continue;
+		hits++;
+		std_ok += (o->standard == VS_PAL && r->label == TRACE_LABEL_PAL) ||
+				  (o->standard == VS_NTSC && r->label == TRACE_LABEL_NTSC);
+	}
+	if (n == 0) return 0;
+
+	memset(row, 0, sizeof(*row));
+	snprintf(row->variant, sizeof(row->variant), "%s", variant->name);
+	snprintf(row->cls, sizeof(row->cls), "video");
+	if (all) snprintf(row->snr, sizeof(row->snr), "all");
+	else if (snr == TRACE_SNR_NONE) row->snr[0] = 0;
+	else snprintf(row->snr, sizeof(row->snr), "%d", snr);
+	row->traces = n;
+	row->pd = (double) hits / n;
+	row->std_ok = variant->field ? (double) std_ok / n : NAN;
+	row->tta_median_ms = row->tta_p99_ms = NAN;
+	if (alarmed != 0) {
+		qsort(scratch, alarmed, sizeof(double), cmp_double);
+		row->tta_median_ms = percentile(scratch, alarmed, 0.5);
+		row->tta_p99_ms = percentile(scratch, alarmed, 0.99);
+	}
+	row->fa_per_hour = NAN;
+	row->hours = NAN;
+	return 1;
+}
+
+static int noise_row(Row_t *row, const ItemResult_t *res, size_t count, size_t v, const Variant_t *variant) {
+	size_t n = 0;
+	uint32_t alarms = 0;
+	double seconds = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (!res[i].ok || res[i].label != TRACE_LABEL_NOISE) continue;
+		n++;
+		alarms += res[i].v[v].alarms;
+		seconds += res[i].seconds;
+	}
+	if (n == 0) return 0;
+
+	memset(row, 0, sizeof(*row));
+	snprintf(row->variant, sizeof(row->variant), "%s", variant->name);
+	snprintf(row->cls, sizeof(row->cls), "noise");
+	row->traces = n;
+	row->pd = row->std_ok = row->tta_median_ms = row->tta_p99_ms = NAN;
+	row->false_alarms = alarms;
+	row->hours = seconds / 3600;
+	row->fa_per_hour = alarms / row->hours;
+	return 1;
+}
+
+static void csv_num(FILE *f, double x, const char *fmt) {
+	fputc(',', f);
+	if (!isnan(x)) fprintf(f, fmt, x);
+}
+
+static void print_row(FILE *f, const Row_t *row) {
+	fprintf(f, "%s,%s,%s,%zu", row->variant, row->cls, row->snr, row->traces);
+	csv_num(f, row->pd, "%.3f");
+	csv_num(f, row->std_ok, "%.3f");
+	csv_num(f, row->tta_median_ms, "%.1f");
+	csv_num(f, row->tta_p99_ms, "%.1f");
+	if (strcmp(row->cls, "noise") == 0) fprintf(f, ",%u", row->false_alarms);
+	else fputc(',', f);
+	csv_num(f, row->fa_per_hour, "%.2f");
+	csv_num(f, row->hours, "%.3f");
+	fputc('\n', f);
+}
+
+#define BENCH_CSV_HEADER "variant,class,snr_db,traces,pd,std_ok,tta_median_ms,tta_p99_ms,false_alarms,fa_per_hour,hours"
+
+/**
+ * @brief Splits one CSV line into a row; empty numeric fields become NAN.
+ */
+static int parse_row(char *line, Row_t *row) {
+	char *field[11];
+	int n = 0;
+	char *p;
+
+	line[strcspn(line, "\r\n")] = 0;
+	while ((p = strsep(&line, ",")) != NULL && n < 11) {
+		field[n++] = p;
+	}
+	if (n != 11 || strcmp(field[0], "variant") == 0) return 0;
+
+	memset(row, 0, sizeof(*row));
+	snprintf(row->variant, sizeof(row->variant), "%s", field[0]);
+	snprintf(row->cls, sizeof(row->cls), "%s", field[1]);
+	snprintf(row->snr, sizeof(row->snr), "%s", field[2]);
+	row->traces = strtoul(field[3], NULL, 10);
+	double *num[] = { &row->pd, &row->std_ok, &row->tta_median_ms, &row->tta_p99_ms };
+	for (int i = 0; i < 4; i++) {
+		*num[i] = field[4 + i][0] ? atof(field[4 + i]) : NAN;
+	}
+	row->false_alarms = strtoul(field[8], NULL, 10);
+	row->fa_per_hour = field[9][0] ? atof(field[9]) : NAN;
+	row->hours = field[10][0] ? atof(field[10]) : NAN;
+	return 1;
+}
+
+/**
+ * @brief Checks a row against its baseline, printing each regression.
+ *
+ * @param tol Allowed relative latency and false alarm increase.
+ * @return Number of regressions.
+ */
+static int compare_row(const Row_t *row, const Row_t *base, double tol) {
+	int bad = 0;
+	const char *name = row->variant;
+
+	if (!isnan(base->pd) && !isnan(row->pd) && row->pd < base->pd - BENCH_PD_TOL) {
+		fprintf(stderr, "regression: %s %s snr %s pd %.3f < %.3f\n", name, row->cls, row->snr, row->pd, base->pd);
+		bad++;
+	}
+	if (!isnan(base->tta_median_ms) && (isnan(row->tta_median_ms) || row->tta_median_ms > base->tta_median_ms * (1 + tol))) {
+		fprintf(stderr, "regression: %s %s snr %s median time to alarm %.1f > %.1f ms\n",
+				name, row->cls, row->snr, row->tta_median_ms, base->tta_median_ms);
+		bad++;
+	}
+	if (!isnan(base->tta_p99_ms) && (isnan(row->tta_p99_ms) || row->tta_p99_ms > base->tta_p99_ms * (1 + tol))) {
+		fprintf(stderr, "regression: %s %s snr %s p99 time to alarm %.1f > %.1f ms\n",
+				name, row->cls, row->snr, row->tta_p99_ms, base->tta_p99_ms);
+		bad++;
+	}
+	if (!isnan(base->fa_per_hour) && row->fa_per_hour > base->fa_per_hour * (1 + tol) && row->false_alarms > base->false_alarms) {
+		fprintf(stderr, "regression: %s noise %.2f > %.2f false alarms per hour\n", name, row->fa_per_hour, base->fa_per_hour);
+		bad++;
+	}
+	return bad;
+}
+
+static int compare(const char *path, const Row_t *rows, size_t count, double tol) {
+	FILE *f = fopen(path, "r");
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	char line[512];
+	int bad = 0;
+	Row_t base;
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (!parse_row(line, &base)) continue;
+		for (size_t i = 0; i < count; i++) {
+			if (strcmp(rows[i].variant, base.variant) == 0 && strcmp(rows[i].cls, base.cls) == 0 &&
+				strcmp(rows[i].snr, base.snr) == 0) {
+				bad += compare_row(&rows[i], &base, tol);
+			}
+		}
+	}
+	fclose(f);
+	return bad;
+}
+
+static int select_variants(Bench_t *bench, char *list) {
+	char *name;
+	while ((name = strsep(&list, ",")) != NULL) {
+		size_t i;
+		for (i = 0; i < BENCH_VARIANTS && strcmp(_variants[i].name, name) != 0; i++) {
+		}
+		if (i == BENCH_VARIANTS) {
+			fprintf(stderr, "unknown variant %s\n", name);
+			return -1;
+		}
+		// Each variant at most once keeps the count within BENCH_MAX_VARIANTS
+		for (size_t k = 0; k < bench->variant_count; k++) {
+			if (bench->variants[k] == &_variants[i]) {
+				fprintf(stderr, "variant %s given twice\n", name);
+				return -1;
+			}
+		}
+		bench->variants[bench->variant_count++] = &_variants[i];
+	}
+	return 0;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [options] [trace...]\n"
+			"  -g           add the built-in synthetic corpus\n"
+			"  -n REPS      generated video traces per standard and SNR (default 8)\n"
+			"  -d SEC       generated video trace length (default 2)\n"
+			"  -m MIN       generated noise and interferer minutes (default 20)\n"
+			"  -S SEED      first generator seed (default 1)\n"
+			"  -V LIST      variants, comma separated (default all:", argv0);
+	for (size_t i = 0; i < BENCH_VARIANTS; i++) {
+		fprintf(stderr, " %s", _variants[i].name);
+	}
+	fprintf(stderr, ")\n"
+			"  -t H:L       fixed band of the non-adaptive variants (default 62:48)\n"
+			"  -j N         worker processes (default: all CPUs)\n"
+			"  -o FILE      write the CSV to FILE instead of stdout\n"
+			"  -c FILE      compare with a baseline CSV, exit 3 on a regression\n"
+			"  -T PCT       latency and false alarm tolerance for -c (default 10)\n");
+}
+
+int main(int argc, char **argv) {
+	Bench_t bench = { .threshold_high = 62, .threshold_low = 48 };
+	int generated = 0, reps = 8, jobs = 0;
+	double video_s = 2, noise_min = 20, tol = 0.10;
+	uint64_t seed = 1;
+	const char *out_path = NULL, *base_path = NULL;
+	char *variant_list = NULL;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "gn:d:m:S:V:t:j:o:c:T:h")) != -1) {
+		switch (opt) {
+			case 'g':
+				generated = 1;
+				break;
+			case 'n':
+				reps = atoi(optarg);
+				break;
+			case 'd':
+				video_s = atof(optarg);
+				break;
+			case 'm':
+				noise_min = atof(optarg);
+				break;
+			case 'S':
+				seed = strtoull(optarg, NULL, 0);
+				break;
+			case 'V':
+				variant_list = optarg;
+				break;
+			case 't': {
+				unsigned high, low;
+				if (sscanf(optarg, "%u:%u", &high, &low) != 2 || high > 255 || low >= high) {
+					usage(argv[0]);
+					return 2;
+				}
+				bench.threshold_high = high;
+				bench.threshold_low = low;
+				break;
+			}
+			case 'j':
+				jobs = atoi(optarg);
+				break;
+			case 'o':
+				out_path = optarg;
+				break;
+			case 'c':
+				base_path = optarg;
+				break;
+			case 'T':
+				tol = atof(optarg) / 100;
+				break;
+			default:
+				usage(argv[0]);
+				return 2;
+		}
+	}
+
+	size_t files = argc - optind;
+	if ((!generated && files == 0) || reps < 0 || video_s <= 0 || noise_min < 0) {
+		usage(argv[0]);
+		return 2;
+	}
+	if (variant_list != NULL) {
+		if (select_variants(&bench, variant_list) != 0) return 2;
+	} else {
+		for (size_t i = 0; i < BENCH_VARIANTS; i++) {
+			bench.variants[bench.variant_count++] = &_variants[i];
+		}
+	}
+
+	size_t max_items = files + (generated ? CORPUS_SyntheticCount(reps, noise_min) : 0);
+	bench.items = calloc(max_items, sizeof(CorpusItem_t));
+	size_t count = 0;
+	for (size_t i = 0; i < files; i++) {
+		bench.items[count++].path = argv[optind + i];
+	}
+	if (generated) count = CORPUS_AddSynthetic(bench.items, count, reps, video_s, noise_min, seed);
+
+	ItemResult_t *res = calloc(count, sizeof(ItemResult_t));
+	double *scratch = calloc(count, sizeof(double));
+	fprintf(stderr, "%zu traces x %zu variants\n", count, bench.variant_count);
+	if (res == NULL || scratch == NULL || PAR_Map(jobs, count, run_item, &bench, res, sizeof(ItemResult_t)) != 0) {
+		fprintf(stderr, "benchmark failed\n");
+		return 1;
+	}
+
+	// Video rows per SNR in ascending order, then all video, then noise
+	Row_t *rows = calloc(bench.variant_count * 260, sizeof(Row_t));
+	size_t row_count = 0;
+	for (size_t v = 0; v < bench.variant_count; v++) {
+		const Variant_t *variant = bench.variants[v];
+		for (int snr = TRACE_SNR_NONE; snr <= 127; snr++) {
+			row_count += video_row(&rows[row_count], res, count, v, variant, snr, scratch);
+		}
+		row_count += video_row(&rows[row_count], res, count, v, variant, TRACE_SNR_NONE - 1, scratch);
+		row_count += noise_row(&rows[row_count], res, count, v, variant);
+	}
+
+	FILE *out = stdout;
+	if (out_path != NULL && (out = fopen(out_path, "w")) == NULL) {
+		perror(out_path);
+		return 1;
+	}
+	fprintf(out, BENCH_CSV_HEADER "\n");
+	for (size_t i = 0; i < row_count; i++) {
+		print_row(out, &rows[i]);
+	}
+	if (out != stdout) fclose(out);
+
+	int failed = 0;
+	for (size_t i = 0; i < count; i++) {
+		failed |= !res[i].ok;
+	}
+
+	int status = failed;
+	if (base_path != NULL) {
+		int bad = compare(base_path, rows, row_count, tol);
+		if (bad < 0) status = 1;
+		else if (bad > 0) status = 3;
+	}
+
+	free(rows);
+	free(scratch);
+	free(res);
+	free(bench.items);
+	return status;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file svo_gen.c
+ * @brief Writes synthetic composite video traces for svo_sim and the benchmarks.
+ */
+
+#include "synth.h"
+#include "adc_pulse_freq.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GEN_CHUNK   65536   ///< Samples generated and written at a time
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [options] -o out.svt\n"
+			"  -t pal|ntsc|none     video standard (default pal)\n"
+			"  -d SEC               duration (default 10)\n"
+			"  -r HZ                sample rate, 100000..875000 (default 800000)\n"
+			"  -a COUNTS            sync tip to white amplitude (default 100)\n"
+			"  -c COUNTS            sync tip level (default 40)\n"
+			"  -I                   inverted polarity, sync tips up\n"
+			"  -n COUNTS            white noise RMS\n"
+			"  -s DB                white noise for a sync-depth SNR instead of -n\n"
+			"  -f PPM               line/field frequency error\n"
+			"  -b HZ                one-pole band limit\n"
+			"  -e US:GAIN           multipath echo\n"
+			"  -g GAIN[:HZ[:US]]    edge ringing, frequency and decay (150000, 5)\n"
+			"  -D RATE[:MS]         dropouts per second, mean length (20)\n"
+			"  -i tone:HZ:PP        sine interferer, peak to peak counts\n"
+			"  -i pulse:HZ:US:PP    pulse train interferer\n"
+			"  -i fm:HZ:SPAN:PP     swept sine interferer\n"
+			"  -S SEED              noise seed (default 1)\n",
+			argv0);
+}
+
+/**
+ * @brief Parses an -i argument.
+ */
+static int parse_interferer(SYN_Config_t *c, const char *arg) {
+	if (sscanf(arg, "tone:%lf:%lf", &c->int_hz, &c->int_amplitude) == 2) {
+		c->interferer = SYN_INT_TONE;
+	} else if (sscanf(arg, "pulse:%lf:%lf:%lf", &c->int_hz, &c->int_width_us, &c->int_amplitude) == 3) {
+		c->interferer = SYN_INT_PULSE;
+	} else if (sscanf(arg, "fm:%lf:%lf:%lf", &c->int_hz, &c->int_span_hz, &c->int_amplitude) == 3) {
+		c->interferer = SYN_INT_FM;
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	SYN_Config_t c;
+	const char *path = NULL;
+	double seconds = 10;
+	double snr_db = NAN;
+	int opt;
+
+	SYN_Defaults(&c);
+	while ((opt = getopt(argc, argv, "o:t:d:r:a:c:In:s:f:b:e:g:D:i:S:h")) != -1) {
+		int ok = 1;
+		switch (opt) {
+			case 'o':
+				path = optarg;
+				break;
+			case 't':
+				if (strcmp(optarg, "pal") == 0) c.video = SYN_VIDEO_PAL;
+				else if (strcmp(optarg, "ntsc") == 0) c.video = SYN_VIDEO_NTSC;
+				else if (strcmp(optarg, "none") == 0) c.video = SYN_VIDEO_NONE;
+				else ok = 0;
+				break;
+			case 'd':
+				seconds = atof(optarg);
+				break;
+			case 'r':
+				c.sample_rate = strtoul(optarg, NULL, 0);
+				break;
+			case 'a':
+				c.amplitude = atof(optarg);
+				break;
+			case 'c':
+				c.dc = atof(optarg);
+				break;
+			case 'I':
+				c.invert = 1;
+				break;
+			case 'n':
+				c.noise_rms = atof(optarg);
+				break;
+			case 's':
+				snr_db = atof(optarg);
+				break;
+			case 'f':
+				c.line_ppm = atof(optarg);
+				break;
+			case 'b':
+				c.bandwidth_hz = atof(optarg);
+				break;
+			case 'e':
+				ok = sscanf(optarg, "%lf:%lf", &c.echo_us, &c.echo_gain) == 2;
+				break;
+			case 'g':
+				ok = sscanf(optarg, "%lf:%lf:%lf", &c.ring_gain, &c.ring_hz, &c.ring_decay_us) >= 1;
+				break;
+			case 'D':
+				ok = sscanf(optarg, "%lf:%lf", &c.dropout_rate, &c.dropout_ms) >= 1;
+				break;
+			case 'i':
+				ok = parse_interferer(&c, optarg) == 0;
+				break;
+			case 'S':
+				c.seed = strtoull(optarg, NULL, 0);
+				break;
+			default:
+				ok = 0;
+				break;
+		}
+		if (!ok) {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	if (path == NULL || c.sample_rate == 0 || seconds <= 0) {
+		usage(argv[0]);
+		return 2;
+	}
+	if (c.sample_rate < FREQ_MIN_SAMPLE_RATE || c.sample_rate > FREQ_MAX_SAMPLE_RATE) {
+		fprintf(stderr, "sample rate must be %u..%u\n", FREQ_MIN_SAMPLE_RATE, FREQ_MAX_SAMPLE_RATE);
+		return 2;
+	}
+	if (!isnan(snr_db)) SYN_SetSnr(&c, snr_db);
+
+	SYN_Generator_t gen;
+	FILE *f = fopen(path, "wb");
+	if (f == NULL) {
+		perror(path);
+		return 1;
+	}
+	if (SYN_Init(&gen, &c) != 0 || TRACE_WriteHeader(f, c.sample_rate, SYN_Label(&c), SYN_SnrDb(&c)) != 0) {
+		perror(path);
+		fclose(f);
+		return 1;
+	}
+
+	static uint8_t buf[GEN_CHUNK];
+	uint64_t left = (uint64_t) (seconds * c.sample_rate);
+	while (left != 0) {
+		size_t n = (left < GEN_CHUNK) ? left : GEN_CHUNK;
+		SYN_Generate(&gen, buf, n);
+		if (fwrite(buf, 1, n, f) != n) {
+			perror(path);
+			fclose(f);
+			return 1;
+		}
+		left -= n;
+	}
+
+	SYN_Free(&gen);
+	return (fclose(f) == 0) ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file svo_sim.c
+ * @brief Command line replay of ADC traces through the firmware detection logic.
+ *
+ * Each trace runs in a worker process on the virtual clock. One summary line
+ * per trace is printed in argument order; with -v every trace's per-window
+ * statistics come first, each trace's block in a single write so parallel
+ * workers do not interleave them.
+ */
+
+#include "sim.h"
+#include "parallel.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+	char **paths;
+	SIM_Config_t config;
+	int verbose;
+} Job_t;
+
+typedef struct {
+	int ok;                     /**< 0 if the trace could not be opened */
+	uint32_t sample_rate;
+	TraceLabel_t label;
+	SIM_Result_t sim;
+} JobResult_t;
+
+static const char *std_name(VS_Standard_t std) {
+	return (std == VS_PAL) ? "PAL" : (std == VS_NTSC) ? "NTSC" : "-";
+}
+
+static void print_window(const SIM_Window_t *w, void *ctx) {
+	fprintf((FILE *) ctx, "  %6u %8u %6u %6u %6u %4u/%-4u %4u %5s %2u %s\n",
+			w->index, w->end_ms, w->sync.pulses, w->sync.width_ok, w->sync.matched,
+			w->threshold_high, w->threshold_low, w->channel,
+			std_name(w->standard), w->confidence, w->alarm ? "ALARM" : "");
+}
+
+static void run_job(size_t index, void *result, void *ctx) {
+	Job_t *job = ctx;
+	JobResult_t *r = result;
+	Trace_t trace;
+
+	if (TRACE_Open(&trace, job->paths[index]) != 0) return;
+	r->ok = 1;
+	r->sample_rate = trace.header.sample_rate;
+	r->label = trace.header.label;
+
+	SIM_Config_t config = job->config;
+	char *text = NULL;
+	size_t text_len = 0;
+	FILE *out = NULL;
+	if (job->verbose) {
+		out = open_memstream(&text, &text_len);
+		fprintf(out, "%s:\n  %6s %8s %6s %6s %6s %9s %4s %5s %2s\n", job->paths[index],
+				"window", "end_ms", "pulses", "width", "match", "hi/lo", "ch", "std", "cf");
+		config.on_window = print_window;
+		config.ctx = out;
+	}
+
+	SIM_Run(&config, &trace, &r->sim);
+	TRACE_Close(&trace);
+
+	if (out != NULL) {
+		fclose(out);
+		if (write(STDOUT_FILENO, text, text_len) < 0) perror("write");
+		free(text);
+	}
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [options] trace...\n"
+			"  -j N     worker processes (default: all CPUs)\n"
+			"  -w MS    statistics window (default 100)\n"
+			"  -v       print per-window statistics\n"
+			"  -r       resume the search after each alarm\n"
+			"  -t H:L   fixed thresholds H/L instead of the adaptive band\n"
+			"  -s       disable sync width matching\n",
+			argv0);
+}
+
+int main(int argc, char **argv) {
+	Job_t job = { 0 };
+	int jobs = 0;
+	int opt;
+
+	SIM_Defaults(&job.config);
+	while ((opt = getopt(argc, argv, "j:w:vrt:sh")) != -1) {
+		switch (opt) {
+			case 'j':
+				jobs = atoi(optarg);
+				break;
+			case 'w':
+				job.config.window_ms = atoi(optarg);
+				break;
+			case 'v':
+				job.verbose = 1;
+				break;
+			case 'r':
+				job.config.resume = 1;
+				break;
+			case 't': {
+				unsigned high, low;
+				if (sscanf(optarg, "%u:%u", &high, &low) != 2 || high > 255 || low >= high) {
+					usage(argv[0]);
+					return 2;
+				}
+				job.config.threshold_high = high;
+				job.config.threshold_low = low;
+				job.config.adaptive = 0;
+				break;
+			}
+			case 's':
+				job.config.sync_match = 0;
+				break;
+			default:
+				usage(argv[0]);
+				return 2;
+		}
+	}
+	if (optind >= argc) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	size_t count = argc - optind;
+	job.paths = argv + optind;
+	JobResult_t *results = calloc(count, sizeof(*results));
+	if (results == NULL || PAR_Map(jobs, count, run_job, &job, results, sizeof(*results)) != 0) {
+		fprintf(stderr, "simulation failed\n");
+		return 1;
+	}
+
+	int failed = 0;
+	double virt = 0, wall = 0;
+	printf("%-32s %7s %7s %8s %6s %10s %5s %3s %6s %6s\n", "trace", "label", "ksps", "time_s",
+		   "alarms", "to_alarm_s", "std", "ch", "steps", "match%");
+	for (size_t i = 0; i < count; i++) {
+		const JobResult_t *r = &results[i];
+		if (!r->ok) {
+			failed = 1;
+			continue;
+		}
+		const SIM_Result_t *s = &r->sim;
+		char tta[16] = "-";
+		if (s->first_alarm_us >= 0) snprintf(tta, sizeof(tta), "%.3f", s->first_alarm_us / 1e6);
+		printf("%-32s %7s %7.1f %8.2f %6u %10s %5s %3u %6d %6.1f\n", job.paths[i],
+			   TRACE_LabelName(r->label), r->sample_rate / 1e3, s->duration_us / 1e6, s->alarms, tta,
+			   std_name(s->standard), s->channel, s->steps,
+			   s->pulses ? 100.0 * s->matched / s->pulses : 0.0);
+		if (s->short_releases != 0) {
+			fprintf(stderr, "%s: %u step pulses too soon after a release, the receiver merges them\n",
+					job.paths[i], s->short_releases);
+			failed = 1;
+		}
+		virt += s->duration_us / 1e6;
+		wall += s->wall_s;
+	}
+	if (wall > 0) {
+		printf("# %.1f s of signal in %.2f s of CPU time, %.0fx real time per core\n", virt, wall, virt / wall);
+	}
+
+	free(results);
+	return failed;
+}
@@ -0,0 +1,510 @@
+/**
+ * @file svo_sweep.c
+ * @brief Grid or random search of the detection settings over a labelled corpus.
+ *
+ * Each parameter point replays the whole corpus with the firmware detector
+ * (adaptive band, sync matching, field check) and is scored on two
+ * objectives: detection latency, the p-th percentile of the time from search
+ * start to alarm over the video traces, where a trace that does not alarm on
+ * the first channel visited counts as never; and false alarms per hour over
+ * the noise traces. The corpus is loaded once and shared with the worker
+ * processes, which take the points.
+ *
+ * threshold_high/low are only the starting band in adaptive mode, so the
+ * band is tuned through the envelope fractions that place it. The window
+ * length and out-of-band threshold only act when the window count decides
+ * (sequential = 0); points differing only in them are merged otherwise.
+ *
+ * Prints every point as CSV with its Pareto front membership and writes the
+ * chosen point as svo_params.h for a firmware build with SVO_PARAMS.
+ */
+
+#include "sim.h"
+#include "corpus.h"
+#include "channel_detector.h"
+#include "parallel.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SWEEP_MAX_VALUES    16
+#define SWEEP_FIRST_CHANNEL 1       ///< Channel index after the first search step
+
+/**
+ * @brief Swept parameters.
+ */
+enum {
+	P_ENV_HIGH,
+	P_ENV_LOW,
+	P_CH_MIN,
+	P_CH_MAX,
+	P_CH_THR,
+	P_WINDOW,
+	P_SEQUENTIAL,
+	P_COUNT
+};
+
+/**
+ * @brief Search space of one parameter, in natural units.
+ */
+typedef struct {
+	const char *name;
+	double lo, hi;              /**< Random search range */
+	uint8_t integer;            /**< Rounded to whole numbers */
+	uint8_t n;                  /**< Grid values */
+	double values[SWEEP_MAX_VALUES];
+} Param_t;
+
+static Param_t _params[P_COUNT] = {
+	{ "env_high",   0.20, 0.45, 0, 3, { 0.25, 0.30, 0.40 } },
+	{ "env_low",    0.05, 0.25, 0, 3, { 0.10, 0.15, 0.20 } },
+	{ "ch_min",     14.8, 15.5, 0, 3, { 15.0, 15.2, 15.4 } },
+	{ "ch_max",     15.9, 16.8, 0, 3, { 15.9, 16.2, 16.5 } },
+	{ "ch_thr",     1,    20,   1, 3, { 3, 5, 10 } },
+	{ "window",     32,   CD_MAX_WINDOW, 1, 3, { 48, 70, 100 } },
+	{ "sequential", 0,    1,    1, 2, { 0, 1 } },
+};
+
+typedef struct {
+	double v[P_COUNT];
+} Point_t;
+
+/**
+ * @brief Scores of one point.
+ */
+typedef struct {
+	double pd;                  /**< Video traces alarming on the first channel visited */
+	double latency_ms;          /**< INFINITY if more traces miss than the percentile allows */
+	uint32_t false_alarms;
+	double fa_per_hour;
+	uint8_t pareto;
+} Score_t;
+
+typedef struct {
+	const Trace_t *traces;
+	size_t trace_count;
+	const Point_t *points;
+	double percentile;          /**< 0..1 */
+	double noise_hours;
+} Sweep_t;
+
+/**
+ * @brief Point of the build-time defaults.
+ */
+static void default_point(Point_t *p) {
+	FSM_Detection_t d;
+	FSM_DefaultDetection(&d);
+	p->v[P_ENV_HIGH] = FREQ_ENV_HIGH_Q8 / 256.0;
+	p->v[P_ENV_LOW] = FREQ_ENV_LOW_Q8 / 256.0;
+	p->v[P_CH_MIN] = d.ch_min / 256.0;
+	p->v[P_CH_MAX] = d.ch_max / 256.0;
+	p->v[P_CH_THR] = d.ch_thr;
+	p->v[P_WINDOW] = d.window_len;
+	p->v[P_SEQUENTIAL] = d.sequential;
+}
+
+static uint8_t q8(double x) {
+	long v = lround(x * 256);
+	return (v < 1) ? 1 : (v > 255) ? 255 : (uint8_t) v;
+}
+
+static uint16_t khz_q8(double khz) {
+	return (uint16_t) lround(khz * 256);
+}
+
+/**
+ * @brief Rounds a point to what the firmware can represent and merges settings the decision rule ignores.
+ *
+ * @return 0 if the point is not valid.
+ */
+static int canonical(Point_t *p, const Point_t *def) {
+	for (int i = 0; i < P_COUNT; i++) {
+		if (_params[i].integer) p->v[i] = round(p->v[i]);
+	}
+	p->v[P_ENV_HIGH] = q8(p->v[P_ENV_HIGH]) / 256.0;
+	p->v[P_ENV_LOW] = q8(p->v[P_ENV_LOW]) / 256.0;
+	p->v[P_CH_MIN] = khz_q8(p->v[P_CH_MIN]) / 256.0;
+	p->v[P_CH_MAX] = khz_q8(p->v[P_CH_MAX]) / 256.0;
+	if (p->v[P_SEQUENTIAL] != 0) {
+		p->v[P_CH_THR] = def->v[P_CH_THR];
+		p->v[P_WINDOW] = def->v[P_WINDOW];
+	}
+	return p->v[P_ENV_LOW] < p->v[P_ENV_HIGH] && p->v[P_CH_MIN] < p->v[P_CH_MAX] &&
+		   p->v[P_WINDOW] >= 1 && p->v[P_WINDOW] <= CD_MAX_WINDOW && p->v[P_CH_THR] < p->v[P_WINDOW];
+}
+
+/**
+ * @brief Appends a point unless it is invalid or already listed.
+ */
+static size_t add_point(Point_t *points, size_t n, Point_t p, const Point_t *def) {
+	if (!canonical(&p, def)) return n;
+	for (size_t i = 0; i < n; i++) {
+		if (memcmp(&points[i], &p, sizeof(p)) == 0) return n;
+	}
+	points[n] = p;
+	return n + 1;
+}
+
+static size_t grid_points(Point_t *points, size_t n, size_t max, const Point_t *def) {
+	size_t total = 1;
+	for (int i = 0; i < P_COUNT; i++) {
+		total *= _params[i].n;
+	}
+	for (size_t k = 0; k < total && n < max; k++) {
+		Point_t p;
+		size_t rest = k;
+		for (int i = 0; i < P_COUNT; i++) {
+			p.v[i] = _params[i].values[rest % _params[i].n];
+			rest /= _params[i].n;
+		}
+		n = add_point(points, n, p, def);
+	}
+	return n;
+}
+
+static double sweep_uniform(uint64_t *state) {
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return ((*state * 0x2545F4914F6CDD1DULL) >> 11) * 0x1p-53;
+}
+
+static size_t random_points(Point_t *points, size_t n, size_t count, uint64_t seed, const Point_t *def) {
+	uint64_t state = seed ? seed : 1;
+	size_t goal = n + count;
+	for (size_t tries = 0; n < goal && tries < 100 * count; tries++) {
+		Point_t p;
+		for (int i = 0; i < P_COUNT; i++) {
+			const Param_t *pr = &_params[i];
+			double span = pr->hi - pr->lo + (pr->integer ? 1 : 0);
+			p.v[i] = pr->lo + sweep_uniform(&state) * span;
+			if (pr->integer) p.v[i] = floor(p.v[i]);
+		}
+		n = add_point(points, n, p, def);
+	}
+	return n;
+}
+
+static void point_config(const Point_t *p, SIM_Config_t *config) {
+	SIM_Defaults(config);
+	config->window_ms = 0;
+	config->env_high_q8 = q8(p->v[P_ENV_HIGH]);
+	config->env_low_q8 = q8(p->v[P_ENV_LOW]);
+	config->detection.ch_min = khz_q8(p->v[P_CH_MIN]);
+	config->detection.ch_max = khz_q8(p->v[P_CH_MAX]);
+	config->detection.ch_thr = (uint8_t) p->v[P_CH_THR];
+	config->detection.window_len = (uint8_t) p->v[P_WINDOW];
+	config->detection.sequential = (uint8_t) p->v[P_SEQUENTIAL];
+}
+
+static int cmp_double(const void *a, const void *b) {
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+static void score_point(size_t index, void *result, void *ctx) {
+	const Sweep_t *sweep = ctx;
+	Score_t *score = result;
+	SIM_Config_t config;
+	double *tta = malloc(sweep->trace_count * sizeof(double));
+	size_t videos = 0, hits = 0;
+
+	point_config(&sweep->points[index], &config);
+	for (size_t i = 0; i < sweep->trace_count; i++) {
+		const Trace_t *trace = &sweep->traces[i];
+		SIM_Result_t sim;
+
+		config.resume = (trace->header.label == TRACE_LABEL_NOISE);
+		SIM_Run(&config, trace, &sim);
+		if (config.resume) {
+			score->false_alarms += sim.alarms;
+		} else {
+			bool hit = sim.first_alarm_us >= 0 && sim.channel == SWEEP_FIRST_CHANNEL;
+			tta[videos++] = hit ? sim.first_alarm_us / 1e3 : INFINITY;
+			hits += hit;
+		}
+	}
+
+	score->pd = videos ? (double) hits / videos : NAN;
+	score->latency_ms = INFINITY;
+	if (videos != 0) {
+		qsort(tta, videos, sizeof(double), cmp_double);
+		size_t rank = (size_t) ceil(sweep->percentile * videos);
+		score->latency_ms = tta[(rank > 0) ? rank - 1 : 0];
+	}
+	score->fa_per_hour = (sweep->noise_hours > 0) ? score->false_alarms / sweep->noise_hours : NAN;
+	free(tta);
+}
+
+/**
+ * @brief Marks the points no other point beats on both latency and false alarms.
+ */
+static void mark_pareto(Score_t *scores, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		scores[i].pareto = isfinite(scores[i].latency_ms);
+		for (size_t j = 0; j < n && scores[i].pareto; j++) {
+			const Score_t *a = &scores[j], *b = &scores[i];
+			if (a->latency_ms <= b->latency_ms && a->false_alarms <= b->false_alarms &&
+				(a->latency_ms < b->latency_ms || a->false_alarms < b->false_alarms)) {
+				scores[i].pareto = 0;
+			}
+		}
+	}
+}
+
+static int write_params(const char *path, const Point_t *p, const Score_t *s, const Sweep_t *sweep, size_t videos) {
+	FILE *f = fopen(path, "w");
+	if (f == NULL) {
+		perror(path);
+		return -1;
+	}
+
+	fprintf(f, "/**\n"
+			" * @file svo_params.h\n"
+			" * @brief Detection settings chosen by Host/svo_sweep, used when building with SVO_PARAMS.\n"
+			" *\n"
+			" * Corpus: %zu video traces, %.2f h of noise and interferers.\n"
+			" * p%.0f time to alarm %.0f ms, pd %.3f, %u false alarms (%.2f per hour).\n"
+			" */\n\n"
+			"#ifndef SVO_PARAMS_H\n"
+			"#define SVO_PARAMS_H\n\n",
+			videos, sweep->noise_hours, sweep->percentile * 100, s->latency_ms, s->pd, s->false_alarms, s->fa_per_hour);
+	fprintf(f, "#define FREQ_ENV_HIGH_Q8      %-6u ///< %.3f of the envelope span\n", q8(p->v[P_ENV_HIGH]), p->v[P_ENV_HIGH]);
+	fprintf(f, "#define FREQ_ENV_LOW_Q8       %-6u ///< %.3f of the envelope span\n", q8(p->v[P_ENV_LOW]), p->v[P_ENV_LOW]);
+	fprintf(f, "#define FREQ_CH_MIN           %-6u ///< %.3f kHz, Q8.8\n", khz_q8(p->v[P_CH_MIN]), p->v[P_CH_MIN]);
+	fprintf(f, "#define FREQ_CH_MAX           %-6u ///< %.3f kHz, Q8.8\n", khz_q8(p->v[P_CH_MAX]), p->v[P_CH_MAX]);
+	fprintf(f, "#define FREQ_CH_THR           %-6.0f ///< Out-of-range samples tolerated in the window\n", p->v[P_CH_THR]);
+	fprintf(f, "#define FREQ_WINDOW_LEN       %-6.0f ///< Samples in the presence window\n", p->v[P_WINDOW]);
+	fprintf(f, "#define FREQ_CH_SEQUENTIAL    %-6.0f ///< 1: sequential test, 0: window count\n", p->v[P_SEQUENTIAL]);
+	fprintf(f, "\n#endif // SVO_PARAMS_H\n");
+	return fclose(f);
+}
+
+/**
+ * @brief Parses name=v1,v2,... (grid values) or name=lo:hi (range, grid of 3).
+ */
+static int parse_param(char *arg) {
+	char *eq = strchr(arg, '=');
+	if (eq == NULL) return -1;
+	*eq = 0;
+
+	Param_t *pr = NULL;
+	for (int i = 0; i < P_COUNT; i++) {
+		if (strcmp(_params[i].name, arg) == 0) pr = &_params[i];
+	}
+	if (pr == NULL) return -1;
+
+	double lo, hi;
+	char *spec = eq + 1;
+	if (strchr(spec, ':') != NULL) {
+		if (sscanf(spec, "%lf:%lf", &lo, &hi) != 2 || hi < lo) return -1;
+		pr->lo = lo;
+		pr->hi = hi;
+		pr->n = 3;
+		for (int k = 0; k < 3; k++) {
+			pr->values[k] = lo + (hi - lo) * k / 2;
+		}
+		return 0;
+	}
+
+	char *tok;
+	pr->n = 0;
+	while ((tok = strsep(&spec, ",")) != NULL && pr->n < SWEEP_MAX_VALUES) {
+		pr->values[pr->n++] = atof(tok);
+	}
+	if (pr->n == 0) return -1;
+	pr->lo = pr->hi = pr->values[0];
+	for (int k = 1; k < pr->n; k++) {
+		if (pr->values[k] < pr->lo) pr->lo = pr->values[k];
+		if (pr->values[k] > pr->hi) pr->hi = pr->values[k];
+	}
+	return 0;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [options] [trace...]\n"
+			"  -g           add the built-in synthetic corpus\n"
+			"  -n REPS      generated video traces per standard and SNR (default 4)\n"
+			"  -d SEC       generated video trace length (default 2)\n"
+			"  -m MIN       generated noise and interferer minutes (default 5)\n"
+			"  -s DB        leave out video traces below this SNR (default 12)\n"
+			"  -G           full grid instead of random search\n"
+			"  -R N         random points (default 64)\n"
+			"  -S SEED      random search and generator seed (default 1)\n"
+			"  -p NAME=V,V  grid values of a parameter, also its random range\n"
+			"  -p NAME=L:H  range of a parameter, grid of 3\n"
+			"               NAME: env_high env_low ch_min ch_max ch_thr window sequential\n"
+			"  -P PCT       latency percentile (default 75)\n"
+			"  -F RATE      most false alarms per hour for the chosen point (default 0)\n"
+			"  -j N         worker processes (default: all CPUs)\n"
+			"  -o FILE      write the chosen point as svo_params.h\n",
+			argv0);
+}
+
+int main(int argc, char **argv) {
+	int generated = 0, reps = 4, jobs = 0, grid = 0;
+	double video_s = 2, noise_min = 5, min_snr = 12, max_fa = 0;
+	size_t random_count = 64;
+	uint64_t seed = 1;
+	const char *out_path = NULL;
+	Sweep_t sweep = { .percentile = 0.75 };
+	int opt;
+
+	while ((opt = getopt(argc, argv, "gn:d:m:s:GR:S:p:P:F:j:o:h")) != -1) {
+		switch (opt) {
+			case 'g':
+				generated = 1;
+				break;
+			case 'n':
+				reps = atoi(optarg);
+				break;
+			case 'd':
+				video_s = atof(optarg);
+				break;
+			case 'm':
+				noise_min = atof(optarg);
+				break;
+			case 's':
+				min_snr = atof(optarg);
+				break;
+			case 'G':
+				grid = 1;
+				break;
+			case 'R':
+				random_count = strtoul(optarg, NULL, 0);
+				break;
+			case 'S':
+				seed = strtoull(optarg, NULL, 0);
+				break;
+			case 'p':
+				if (parse_param(optarg) != 0) {
+					fprintf(stderr, "bad parameter spec\n");
+					return 2;
+				}
+				break;
+			case 'P':
+				sweep.percentile = atof(optarg) / 100;
+				break;
+			case 'F':
+				max_fa = atof(optarg);
+				break;
+			case 'j':
+				jobs = atoi(optarg);
+				break;
+			case 'o':
+				out_path = optarg;
+				break;
+			default:
+				usage(argv[0]);
+				return 2;
+		}
+	}
+
+	size_t files = argc - optind;
+	if ((!generated && files == 0) || sweep.percentile <= 0 || sweep.percentile > 1) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	// Corpus, loaded once; the workers see it copy-on-write
+	size_t max_items = files + (generated ? CORPUS_SyntheticCount(reps, noise_min) : 0);
+	CorpusItem_t *items = calloc(max_items, sizeof(CorpusItem_t));
+	Trace_t *traces = calloc(max_items, sizeof(Trace_t));
+	size_t *trace_item = calloc(max_items, sizeof(size_t));
+	size_t count = 0;
+	for (size_t i = 0; i < files; i++) {
+		items[count++].path = argv[optind + i];
+	}
+	if (generated) count = CORPUS_AddSynthetic(items, count, reps, video_s, noise_min, seed);
+
+	size_t videos = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (items[i].path == NULL && items[i].syn.video != SYN_VIDEO_NONE && SYN_SnrDb(&items[i].syn) < min_snr) continue;
+		if (CORPUS_Load(&items[i], &traces[sweep.trace_count]) != 0) return 1;
+		trace_item[sweep.trace_count] = i;
+
+		const Trace_t *t = &traces[sweep.trace_count];
+		if (t->header.label == TRACE_LABEL_UNKNOWN ||
+			(t->header.label != TRACE_LABEL_NOISE && t->header.snr_db != TRACE_SNR_NONE && t->header.snr_db < min_snr)) {
+			CORPUS_Unload(&items[i], &traces[sweep.trace_count]);
+			continue;
+		}
+		if (t->header.label == TRACE_LABEL_NOISE) {
+			sweep.noise_hours += (double) t->count / t->header.sample_rate / 3600;
+		} else {
+			videos++;
+		}
+		sweep.trace_count++;
+	}
+	sweep.traces = traces;
+
+	// Points: the build defaults first, then the grid or random samples
+	Point_t def;
+	default_point(&def);
+	size_t max_points = 1 + (grid ? 1 : random_count);
+	if (grid) {
+		for (int i = 0; i < P_COUNT; i++) {
+			max_points *= _params[i].n;
+		}
+	}
+	Point_t *points = calloc(max_points, sizeof(Point_t));
+	size_t n = add_point(points, 0, def, &def);
+	n = grid ? grid_points(points, n, max_points, &def) : random_points(points, n, random_count, seed, &def);
+	sweep.points = points;
+
+	fprintf(stderr, "%zu traces (%zu video, %.2f h noise) x %zu points\n", sweep.trace_count, videos, sweep.noise_hours, n);
+	Score_t *scores = calloc(n, sizeof(Score_t));
+	if (scores == NULL || PAR_Map(jobs, n, score_point, &sweep, scores, sizeof(Score_t)) != 0) {
+		fprintf(stderr, "sweep failed\n");
+		return 1;
+	}
+	mark_pareto(scores, n);
+
+	// Chosen point: lowest latency within the false alarm budget, fewer false alarms on a tie
+	size_t best = n;
+	for (size_t i = 0; i < n; i++) {
+		const Score_t *s = &scores[i];
+		if (!isfinite(s->latency_ms) || !(s->fa_per_hour <= max_fa || isnan(s->fa_per_hour))) continue;
+		if (best == n || s->latency_ms < scores[best].latency_ms ||
+			(s->latency_ms == scores[best].latency_ms && s->false_alarms < scores[best].false_alarms)) {
+			best = i;
+		}
+	}
+
+	printf("point,pareto,chosen");
+	for (int i = 0; i < P_COUNT; i++) {
+		printf(",%s", _params[i].name);
+	}
+	printf(",pd,latency_ms,false_alarms,fa_per_hour\n");
+	for (size_t i = 0; i < n; i++) {
+		const Score_t *s = &scores[i];
+		printf("%s,%u,%u,%.3f,%.3f,%.3f,%.3f,%.0f,%.0f,%.0f,%.3f,", (i == 0) ? "default" : "", s->pareto, i == best,
+			   points[i].v[0], points[i].v[1], points[i].v[2], points[i].v[3], points[i].v[4], points[i].v[5],
+			   points[i].v[6], s->pd);
+		if (isfinite(s->latency_ms)) printf("%.1f", s->latency_ms);
+		printf(",%u,%.2f\n", s->false_alarms, s->fa_per_hour);
+	}
+
+	int status = 0;
+	if (best == n) {
+		fprintf(stderr, "no point meets the latency percentile within %.2f false alarms per hour\n", max_fa);
+		status = 1;
+	} else {
+		fprintf(stderr, "chosen: p%.0f %.1f ms, %u false alarms, pd %.3f%s\n", sweep.percentile * 100,
+				scores[best].latency_ms, scores[best].false_alarms, scores[best].pd, (best == 0) ? " (defaults)" : "");
+		if (out_path != NULL && write_params(out_path, &points[best], &scores[best], &sweep, videos) != 0) status = 1;
+	}
+
+	for (size_t i = 0; i < sweep.trace_count; i++) {
+		CORPUS_Unload(&items[trace_item[i]], &traces[i]);
+	}
+	free(scores);
+	free(points);
+	free(trace_item);
+	free(traces);
+	free(items);
+	return status;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file synth.c
+ * @brief Synthetic composite video generator.
+ */
+
+#include "synth.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Sync and blanking timing of one standard, microseconds.
+ */
+typedef struct {
+	double line_us;             /**< Nominal line period */
+	uint16_t field_halves;      /**< Half lines per field, also lines per frame */
+	uint8_t vbi_block;          /**< Half lines of each pre-equalising, broad and post-equalising block */
+	double eq_us;               /**< Equalising pulse width */
+	double broad_gap_us;        /**< Serration between broad pulses */
+	double sync_us;             /**< Line sync width */
+	double active_us;           /**< Start of the active line (end of the back porch) */
+	double front_us;            /**< Front porch */
+	double black;               /**< Black level */
+} SynStandard_t;
+
+static const SynStandard_t _syn_pal = { 64.0, 625, 5, 2.35, 4.7, 4.7, 10.5, 1.65, SYN_SYNC_DEPTH };
+static const SynStandard_t _syn_ntsc = { 1e6 / 15734.264, 525, 6, 2.3, 4.7, 4.7, 9.4, 1.5, SYN_SYNC_DEPTH + 0.05 };
+
+void SYN_Defaults(SYN_Config_t *config) {
+	memset(config, 0, sizeof(*config));
+	config->sample_rate = 800000;
+	config->video = SYN_VIDEO_PAL;
+	config->amplitude = 100;
+	config->dc = 40;
+	config->ring_hz = 150000;
+	config->ring_decay_us = 5;
+	config->dropout_ms = 20;
+	config->int_hz = 15625;
+	config->int_width_us = 10;
+	config->seed = 1;
+}
+
+void SYN_SetSnr(SYN_Config_t *config, double snr_db) {
+	config->noise_rms = config->amplitude * SYN_SYNC_DEPTH / pow(10, snr_db / 20);
+}
+
+TraceLabel_t SYN_Label(const SYN_Config_t *config) {
+	switch (config->video) {
+		case SYN_VIDEO_PAL:
+			return TRACE_LABEL_PAL;
+		case SYN_VIDEO_NTSC:
+			return TRACE_LABEL_NTSC;
+		default:
+			return TRACE_LABEL_NOISE;
+	}
+}
+
+int8_t SYN_SnrDb(const SYN_Config_t *config) {
+	if (config->video == SYN_VIDEO_NONE) return TRACE_SNR_NONE;
+	if (config->noise_rms <= 0) return 127;
+	double snr = round(20 * log10(config->amplitude * SYN_SYNC_DEPTH / config->noise_rms));
+	return (snr > 127) ? 127 : (snr < -127) ? -127 : (int8_t) snr;
+}
+
+int SYN_Init(SYN_Generator_t *gen, const SYN_Config_t *config) {
+	const double fs = config->sample_rate;
+
+	memset(gen, 0, sizeof(*gen));
+	gen->cfg = *config;
+	gen->rng = config->seed ? config->seed : 1;
+	gen->noise_spare = NAN;
+
+	const SynStandard_t *std = (config->video == SYN_VIDEO_NTSC) ? &_syn_ntsc : &_syn_pal;
+	gen->line_us = std->line_us / (1 + config->line_ppm * 1e-6);
+
+	if (config->echo_gain != 0) {
+		gen->echo_len = (size_t) lround(config->echo_us * fs * 1e-6);
+		if (gen->echo_len == 0) gen->echo_len = 1;
+		gen->echo = calloc(gen->echo_len, sizeof(float));
+		if (gen->echo == NULL) return -1;
+	}
+
+	if (config->ring_gain != 0) {
+		double rho = exp(-1e6 / (config->ring_decay_us * fs));
+		gen->ring_a1 = 2 * rho * cos(2 * M_PI * config->ring_hz / fs);
+		gen->ring_a2 = rho * rho;
+	}
+
+	gen->lp_k = (config->bandwidth_hz > 0) ? 1 - exp(-2 * M_PI * config->bandwidth_hz / fs) : 1;
+	gen->lp = config->dc + config->amplitude * SYN_SYNC_DEPTH;
+	gen->prev = gen->lp;
+	return 0;
+}
+
+void SYN_Free(SYN_Generator_t *gen) {
+	free(gen->echo);
+	gen->echo = NULL;
+}
+
+/**
+ * @brief xorshift64*, uniform in (0, 1).
+ */
+static double syn_uniform(SYN_Generator_t *gen) {
+	gen->rng ^= gen->rng >> 12;
+	gen->rng ^= gen->rng << 25;
+	gen->rng ^= gen->rng >> 27;
+	return ((gen->rng * 0x2545F4914F6CDD1DULL >> 11) + 0.5) * 0x1p-53;
+}
+
+static double syn_gauss(SYN_Generator_t *gen) {
+	if (!isnan(gen->noise_spare)) {
+		double v = gen->noise_spare;
+		gen->noise_spare = NAN;
+		return v;
+	}
+	double r = sqrt(-2 * log(syn_uniform(gen)));
+	double a = 2 * M_PI * syn_uniform(gen);
+	gen->noise_spare = r * sin(a);
+	return r * cos(a);
+}
+
+/**
+ * @brief Still picture: a per-line pattern so lines differ but fields repeat.
+ *
+ * @param line Line number within the frame.
+ * @param x Time into the active line, us.
+ */
+static double syn_picture(uint32_t line, double x) {
+	uint32_t h = line * 2654435761U;
+	double shade = (h >> 8) * 0x1p-24;
+	double luma = 0.5 + 0.3 * sin(x * 0.3 + 6.28 * shade) + 0.2 * (shade - 0.5);
+	return (luma < 0) ? 0 : (luma > 1) ? 1 : luma;
+}
+
+/**
+ * @brief Clean composite level at time t.
+ */
+static double syn_video(const SYN_Generator_t *gen, double t) {
+	const SynStandard_t *std = (gen->cfg.video == SYN_VIDEO_NTSC) ? &_syn_ntsc : &_syn_pal;
+	const double half = gen->line_us / 2;
+	uint64_t hi = (uint64_t) (t / half);
+	double ph = t - hi * half;
+	uint32_t h = hi % std->field_halves;
+
+	if (h < 3U * std->vbi_block) {
+		// Vertical interval: equalising, broad, equalising pulses every half line
+		if (h >= std->vbi_block && h < 2U * std->vbi_block) {
+			return (ph < half - std->broad_gap_us) ? 0 : SYN_SYNC_DEPTH;
+		}
+		return (ph < std->eq_us) ? 0 : SYN_SYNC_DEPTH;
+	}
+
+	// Line syncs sit on even half lines; the field length puts the
+	// interlace half line at the end of every other field
+	double x = ph + ((hi & 1) ? half : 0);
+	if (x < std->sync_us) return 0;
+	if (x < std->active_us || x > gen->line_us - std->front_us) return SYN_SYNC_DEPTH;
+	uint32_t line = (uint32_t) ((hi / 2) % std->field_halves);
+	return std->black + (1 - std->black) * syn_picture(line, x - std->active_us);
+}
+
+void SYN_Generate(SYN_Generator_t *gen, uint8_t *out, size_t count) {
+	const SYN_Config_t *c = &gen->cfg;
+	const double fs = c->sample_rate;
+
+	for (size_t i = 0; i < count; i++, gen->n++) {
+		const double t = gen->n * 1e6 / fs;
+
+		// Dropouts: Poisson starts, exponential lengths, signal falls to blanking
+		if (c->dropout_rate > 0 && gen->n >= gen->dropout_end && syn_uniform(gen) < c->dropout_rate / fs) {
+			gen->dropout_end = gen->n + (uint64_t) (-log(syn_uniform(gen)) * c->dropout_ms * fs * 1e-3);
+		}
+		double s = SYN_SYNC_DEPTH;
+		if (c->video != SYN_VIDEO_NONE && gen->n >= gen->dropout_end) {
+			s = syn_video(gen, t);
+		}
+		double v = c->amplitude * (c->invert ? 1 - s : s);
+
+		if (gen->echo != NULL) {
+			size_t idx = gen->n % gen->echo_len;
+			double delayed = gen->echo[idx];
+			gen->echo[idx] = (float) v;
+			v += c->echo_gain * delayed;
+		}
+		v += c->dc;
+
+		if (c->ring_gain != 0) {
+			double r = gen->ring_a1 * gen->ring[0] - gen->ring_a2 * gen->ring[1] + c->ring_gain * (v - gen->prev);
+			gen->ring[1] = gen->ring[0];
+			gen->ring[0] = r;
+			gen->prev = v;
+			v += r;
+		}
+
+		gen->lp += gen->lp_k * (v - gen->lp);
+		v = gen->lp;
+
+		switch (c->interferer) {
+			case SYN_INT_TONE:
+				v += 0.5 * c->int_amplitude * sin(gen->int_phase);
+				gen->int_phase += 2 * M_PI * c->int_hz / fs;
+				break;
+			case SYN_INT_PULSE:
+				if (gen->int_phase < c->int_width_us * 1e-6 * c->int_hz) v += c->int_amplitude;
+				gen->int_phase += c->int_hz / fs;
+				if (gen->int_phase >= 1) gen->int_phase -= 1;
+				break;
+			case SYN_INT_FM:
+				v += 0.5 * c->int_amplitude * sin(gen->int_phase);
+				gen->int_phase += 2 * M_PI * (c->int_hz + c->int_span_hz * sin(2 * M_PI * SYN_FM_RATE_HZ * t * 1e-6)) / fs;
+				break;
+			default:
+				break;
+		}
+		if (gen->int_phase > 2 * M_PI * 1e6) gen->int_phase = fmod(gen->int_phase, 2 * M_PI);
+
+		if (c->noise_rms > 0) v += c->noise_rms * syn_gauss(gen);
+
+		v = round(v);
+		out[i] = (v < 0) ? 0 : (v > 255) ? 255 : (uint8_t) v;
+	}
+}
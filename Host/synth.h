@@ -0,0 +1,123 @@
+/**
+ * @file synth.h
+ * @brief Synthetic composite video as the V_AMP input would see it.
+ *
+ * Sync timing follows the 625/50 and 525/60 standards on a half-line grid:
+ * line syncs on every other half line, equalising and broad pulses on every
+ * half line through the vertical interval, and the interlace half line
+ * falling out of the field length. Picture content is a still frame. On top
+ * of the clean waveform the generator adds, in signal order: dropouts,
+ * a multipath echo, edge ringing, band limiting, an interferer and white
+ * noise, then quantises to the 8-bit ADC range.
+ *
+ * Levels are fractions of the sync tip to peak white amplitude: sync tip 0,
+ * blanking 0.3, white 1. SNR is quoted for the sync depth, i.e. blanking
+ * minus sync tip over the noise RMS, since that is what the comparator sees.
+ */
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "trace.h"
+
+#define SYN_SYNC_DEPTH      0.3     ///< Blanking level above the sync tip, fraction of the amplitude
+
+/**
+ * @brief Video standard of the generated signal.
+ */
+typedef enum {
+    SYN_VIDEO_NONE,     /**< Blanking level only, e.g. for interferer or noise traces */
+    SYN_VIDEO_PAL,      /**< 625 lines, 50 Hz fields */
+    SYN_VIDEO_NTSC      /**< 525 lines, 59.94 Hz fields */
+} SYN_Video_t;
+
+/**
+ * @brief Non-video interferer types.
+ */
+typedef enum {
+    SYN_INT_NONE,
+    SYN_INT_TONE,       /**< Sine at int_hz */
+    SYN_INT_PULSE,      /**< Rectangular pulses at int_hz, int_width_us wide */
+    SYN_INT_FM          /**< Sine swept int_hz +- int_span_hz at SYN_FM_RATE_HZ */
+} SYN_Interferer_t;
+
+#define SYN_FM_RATE_HZ      50.0    ///< Sweep rate of the FM interferer
+
+/**
+ * @brief Generator settings. SYN_Defaults() gives a clean PAL signal.
+ */
+typedef struct {
+    uint32_t sample_rate;       /**< Samples per second */
+    SYN_Video_t video;
+    double amplitude;           /**< Sync tip to peak white, ADC counts */
+    double dc;                  /**< Sync tip level, ADC counts */
+    int invert;                 /**< Sync tips at the top instead */
+    double noise_rms;           /**< White noise, ADC counts */
+    double line_ppm;            /**< Line and field frequency error */
+    double bandwidth_hz;        /**< One-pole low pass corner, 0 for none */
+    double echo_us;             /**< Multipath delay */
+    double echo_gain;           /**< Multipath echo level relative to the direct signal, 0 for none */
+    double ring_gain;           /**< Edge ringing excitation, 0 for none */
+    double ring_hz;             /**< Ringing frequency */
+    double ring_decay_us;       /**< Ringing time constant */
+    double dropout_rate;        /**< Dropouts per second, 0 for none */
+    double dropout_ms;          /**< Mean dropout length */
+    SYN_Interferer_t interferer;
+    double int_amplitude;       /**< Interferer peak to peak, ADC counts */
+    double int_hz;              /**< Interferer frequency */
+    double int_width_us;        /**< Pulse width of SYN_INT_PULSE */
+    double int_span_hz;         /**< Deviation of SYN_INT_FM */
+    uint64_t seed;              /**< Noise and dropout sequence */
+} SYN_Config_t;
+
+/**
+ * @brief Generator state, streams any number of samples.
+ */
+typedef struct {
+    SYN_Config_t cfg;
+    uint64_t n;                 /**< Next sample index */
+    uint64_t rng;
+    double line_us;             /**< Line period including the frequency error */
+    float *echo;                /**< Delay line of the clean signal */
+    size_t echo_len;
+    double ring[2];             /**< Resonator state */
+    double ring_a1, ring_a2;
+    double prev;                /**< Previous sample into the resonator */
+    double lp;                  /**< Low pass state */
+    double lp_k;
+    uint64_t dropout_end;       /**< Sample index the current dropout ends at */
+    double int_phase;
+    double noise_spare;         /**< Second Box-Muller value, NaN if none */
+} SYN_Generator_t;
+
+/**
+ * @brief Clean PAL at 800 ksps, 100 counts amplitude on a 40 count sync tip.
+ */
+void SYN_Defaults(SYN_Config_t *config);
+
+/**
+ * @brief Sets noise_rms for a sync-depth SNR in dB.
+ */
+void SYN_SetSnr(SYN_Config_t *config, double snr_db);
+
+/**
+ * @brief Trace label and header SNR for a configuration.
+ */
+TraceLabel_t SYN_Label(const SYN_Config_t *config);
+int8_t SYN_SnrDb(const SYN_Config_t *config);
+
+/**
+ * @return 0 on success, -1 if the echo delay line could not be allocated.
+ */
+int SYN_Init(SYN_Generator_t *gen, const SYN_Config_t *config);
+
+/**
+ * @brief Produces the next count samples.
+ */
+void SYN_Generate(SYN_Generator_t *gen, uint8_t *out, size_t count);
+
+void SYN_Free(SYN_Generator_t *gen);
+
+#endif // SYNTH_H
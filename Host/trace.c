@@ -0,0 +1,95 @@
+/**
+ * @file trace.c
+ * @brief Raw ADC trace file access.
+ */
+
+#include "trace.h"
+#include "adc_pulse_freq.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(TraceHeader_t) == 16, "trace header layout");
+
+int TRACE_Open(Trace_t *trace, const char *path) {
+	memset(trace, 0, sizeof(*trace));
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(TraceHeader_t)) {
+		fprintf(stderr, "%s: not a trace file\n", path);
+		close(fd);
+		return -1;
+	}
+
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	// Host tools run on little-endian machines, the header is read as is
+	memcpy(&trace->header, map, sizeof(TraceHeader_t));
+	const TraceHeader_t *h = &trace->header;
+	if (memcmp(h->magic, TRACE_MAGIC, 4) != 0 || h->header_size < sizeof(TraceHeader_t) ||
+	    h->header_size > (size_t) st.st_size || h->sample_rate == 0) {
+		fprintf(stderr, "%s: bad trace header\n", path);
+		munmap(map, st.st_size);
+		return -1;
+	}
+	if (h->sample_rate < FREQ_MIN_SAMPLE_RATE || h->sample_rate > FREQ_MAX_SAMPLE_RATE) {
+		// The target clamps its sample clock to this range, the meter is not built for others
+		fprintf(stderr, "%s: sample rate %u outside %u..%u\n", path, (unsigned) h->sample_rate,
+		        FREQ_MIN_SAMPLE_RATE, FREQ_MAX_SAMPLE_RATE);
+		munmap(map, st.st_size);
+		return -1;
+	}
+
+	trace->samples = (const uint8_t *) map + h->header_size;
+	trace->count = st.st_size - h->header_size;
+	trace->_map = map;
+	trace->_map_len = st.st_size;
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+	return 0;
+}
+
+void TRACE_Close(Trace_t *trace) {
+	if (trace->_map != NULL) {
+		munmap(trace->_map, trace->_map_len);
+	}
+	memset(trace, 0, sizeof(*trace));
+}
+
+int TRACE_WriteHeader(FILE *f, uint32_t sample_rate, TraceLabel_t label, int8_t snr_db) {
+	TraceHeader_t h = {
+		.version = TRACE_VERSION,
+		.header_size = sizeof(TraceHeader_t),
+		.sample_rate = sample_rate,
+		.label = label,
+		.snr_db = snr_db,
+	};
+	memcpy(h.magic, TRACE_MAGIC, 4);
+	return (fwrite(&h, sizeof(h), 1, f) == 1) ? 0 : -1;
+}
+
+const char *TRACE_LabelName(TraceLabel_t label) {
+	switch (label) {
+		case TRACE_LABEL_NOISE:
+			return "noise";
+		case TRACE_LABEL_PAL:
+			return "pal";
+		case TRACE_LABEL_NTSC:
+			return "ntsc";
+		default:
+			return "unknown";
+	}
+}
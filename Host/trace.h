@@ -0,0 +1,80 @@
+/**
+ * @file trace.h
+ * @brief Raw ADC trace files for the host tools.
+ *
+ * A trace is a fixed little-endian header followed by unsigned 8-bit
+ * samples exactly as the ADC delivers them in DMA mode, at the rate given
+ * in the header. The label tells what a correct detector should report, so
+ * recorded and generated traces can share one benchmark corpus.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define TRACE_MAGIC         "SVOT"  ///< First four bytes of every trace
+#define TRACE_VERSION       1       ///< Header layout version written by TRACE_WriteHeader()
+#define TRACE_SNR_NONE      (-128)  ///< snr_db value of traces without a known SNR
+
+/**
+ * @brief What the trace contains, as far as the detector is concerned.
+ */
+typedef enum {
+    TRACE_LABEL_UNKNOWN,    /**< Recording without ground truth */
+    TRACE_LABEL_NOISE,      /**< No video: empty channel or a non-video interferer */
+    TRACE_LABEL_PAL,        /**< PAL video signal */
+    TRACE_LABEL_NTSC        /**< NTSC video signal */
+} TraceLabel_t;
+
+/**
+ * @brief On-disk header, 16 bytes.
+ */
+typedef struct {
+    char magic[4];              /**< TRACE_MAGIC, not terminated */
+    uint16_t version;           /**< TRACE_VERSION */
+    uint16_t header_size;       /**< Offset of the first sample, lets later versions append fields */
+    uint32_t sample_rate;       /**< Samples per second */
+    uint8_t label;              /**< TraceLabel_t */
+    int8_t snr_db;              /**< Signal to noise ratio the trace was made with, TRACE_SNR_NONE if unknown */
+    uint16_t reserved;
+} TraceHeader_t;
+
+/**
+ * @brief Trace mapped into memory.
+ */
+typedef struct {
+    TraceHeader_t header;
+    const uint8_t *samples;     /**< First sample */
+    size_t count;               /**< Number of samples */
+    void *_map;
+    size_t _map_len;
+} Trace_t;
+
+/**
+ * @brief Maps a trace file and checks its header.
+ *
+ * @return 0 on success, -1 with a message on stderr otherwise.
+ */
+int TRACE_Open(Trace_t *trace, const char *path);
+
+/**
+ * @brief Unmaps a trace opened with TRACE_Open().
+ */
+void TRACE_Close(Trace_t *trace);
+
+/**
+ * @brief Writes a current-version header; the samples follow with plain fwrite().
+ *
+ * @return 0 on success, -1 on a write error.
+ */
+int TRACE_WriteHeader(FILE *f, uint32_t sample_rate, TraceLabel_t label, int8_t snr_db);
+
+/**
+ * @brief Short lower-case name of a label.
+ */
+const char *TRACE_LabelName(TraceLabel_t label);
+
+#endif // TRACE_H